@@ -0,0 +1,246 @@
+/*
+Copyright (C) 2010 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AnimationExporter.h"
+#include "Profiler.h"
+
+// VTK
+#include <vtkActor.h>
+#include <vtkImageData.h>
+#include <vtkPNGWriter.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkWindowToImageFilter.h>
+
+// STL
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Qt
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+namespace
+{
+
+/** Writes one captured frame and gives its slot in the queue back. */
+class PNGWriterTask : public QRunnable
+{
+public:
+  PNGWriterTask(vtkImageData* image, const std::string& fileName, QSemaphore* queueSlots, QAtomicInt* failures) :
+    Image(image), FileName(fileName), QueueSlots(queueSlots), Failures(failures) {}
+
+  void run()
+  {
+    // Each task has its own writer, so nothing is shared between the threads
+    vtkSmartPointer<vtkPNGWriter> writer = vtkSmartPointer<vtkPNGWriter>::New();
+    writer->SetFileName(this->FileName.c_str());
+    writer->SetInputData(this->Image);
+    writer->Write();
+    if(writer->GetErrorCode() != 0)
+      {
+      this->Failures->ref();
+      }
+
+    this->QueueSlots->release();
+  }
+
+private:
+  vtkSmartPointer<vtkImageData> Image;
+  std::string FileName;
+  QSemaphore* QueueSlots;
+  QAtomicInt* Failures;
+};
+
+} // end anonymous namespace
+
+AnimationExporter::AnimationExporter()
+{
+  this->From = ColorSpaceModel::RGB;
+  this->To = ColorSpaceModel::HSV;
+  this->NumberOfFrames = 100;
+  this->Size[0] = 800;
+  this->Size[1] = 600;
+  this->OutputPrefix = "frame_";
+  this->NumberOfThreads = QThread::idealThreadCount();
+}
+
+void AnimationExporter::SetFrom(ColorSpaceModel::SpaceEnum from)
+{
+  this->From = from;
+}
+
+void AnimationExporter::SetTo(ColorSpaceModel::SpaceEnum to)
+{
+  this->To = to;
+}
+
+void AnimationExporter::SetNumberOfFrames(unsigned int numberOfFrames)
+{
+  this->NumberOfFrames = numberOfFrames;
+}
+
+void AnimationExporter::SetSize(int width, int height)
+{
+  this->Size[0] = width;
+  this->Size[1] = height;
+}
+
+void AnimationExporter::SetOutputPrefix(const std::string& prefix)
+{
+  this->OutputPrefix = prefix;
+}
+
+void AnimationExporter::SetNumberOfThreads(int numberOfThreads)
+{
+  this->NumberOfThreads = numberOfThreads;
+}
+
+void AnimationExporter::SetTraceFileName(const std::string& fileName)
+{
+  this->TraceFileName = fileName;
+}
+
+bool AnimationExporter::Export()
+{
+  if(this->NumberOfFrames == 0)
+    {
+    return true;
+    }
+
+  Profiler profiler;
+  ColorSpaceModel model(&profiler);
+
+  vtkPoints* currentPoints = model.GetDisplayPoints(this->From)->Points;
+  vtkPoints* nextPoints = model.GetDisplayPoints(this->To)->Points;
+
+  DisplayPoints transitionPoints;
+  transitionPoints.Points->DeepCopy(currentPoints);
+  transitionPoints.PolyData->GetPointData()->SetScalars(model.Colors);
+
+  vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
+  renderer->AddViewProp(transitionPoints.Actor);
+
+  vtkSmartPointer<vtkRenderWindow> renderWindow = vtkSmartPointer<vtkRenderWindow>::New();
+  renderWindow->SetOffScreenRendering(1);
+  renderWindow->SetSize(this->Size);
+  renderWindow->AddRenderer(renderer);
+
+  // Keep the camera fixed for the whole animation by framing both point sets
+  double currentBounds[6];
+  currentPoints->GetBounds(currentBounds);
+  double nextBounds[6];
+  nextPoints->GetBounds(nextBounds);
+  double bounds[6];
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    bounds[2*i] = std::min(currentBounds[2*i], nextBounds[2*i]);
+    bounds[2*i + 1] = std::max(currentBounds[2*i + 1], nextBounds[2*i + 1]);
+    }
+  renderer->ResetCamera(bounds);
+
+  vtkSmartPointer<vtkWindowToImageFilter> windowToImageFilter = vtkSmartPointer<vtkWindowToImageFilter>::New();
+  windowToImageFilter->SetInput(renderWindow);
+  windowToImageFilter->ReadFrontBufferOff();
+
+  int numberOfThreads = std::max(this->NumberOfThreads, 1);
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(numberOfThreads);
+
+  // Bound the number of captured frames waiting to be encoded so a long export
+  // does not hold every frame in memory when encoding is slower than rendering.
+  QSemaphore queueSlots(2 * numberOfThreads);
+  QAtomicInt failures(0);
+
+  qint64 exportStart = profiler.Now();
+  for(unsigned int frame = 0; frame < this->NumberOfFrames; ++frame)
+    {
+    profiler.BeginFrame();
+
+    float transition = 1.0f;
+    if(this->NumberOfFrames > 1)
+      {
+      transition = static_cast<float>(frame)/static_cast<float>(this->NumberOfFrames - 1);
+      }
+
+    {
+    PROFILE_SCOPE(&profiler, "Interpolate");
+    ColorSpaceModel::Interpolate(currentPoints, nextPoints, transition, transitionPoints.Points);
+    transitionPoints.Points->Modified();
+    }
+
+    vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+    {
+    PROFILE_SCOPE(&profiler, "Render");
+    // The filter renders the frame itself (without swapping buffers) and reads the back buffer
+    windowToImageFilter->Modified();
+    windowToImageFilter->Update();
+    image->DeepCopy(windowToImageFilter->GetOutput());
+    }
+
+    std::stringstream fileName;
+    fileName << this->OutputPrefix << std::setfill('0') << std::setw(4) << frame << ".png";
+
+    {
+    PROFILE_SCOPE(&profiler, "WaitForEncoder");
+    queueSlots.acquire();
+    }
+    threadPool.start(new PNGWriterTask(image, fileName.str(), &queueSlots, &failures));
+
+    profiler.EndFrame();
+    }
+
+  threadPool.waitForDone();
+  qint64 exportDuration = profiler.Now() - exportStart;
+
+  bool success = true;
+  if(profiler.GetEnabled())
+    {
+    // Including the encoding of the last frames
+    std::cout << this->NumberOfFrames << " frames in " << exportDuration * 1.0e-6 << " ms ("
+              << this->NumberOfFrames / (exportDuration * 1.0e-9) << " fps)" << std::endl;
+    profiler.WriteSummary(std::cout);
+
+    if(!this->TraceFileName.empty() && !profiler.WriteChromeTrace(this->TraceFileName))
+      {
+      std::cerr << "Could not write the trace to " << this->TraceFileName << "." << std::endl;
+      success = false;
+      }
+    }
+  else if(!this->TraceFileName.empty())
+    {
+    std::cerr << "Profiling is not enabled (COLORSPACES_ENABLE_PROFILING), no trace was written." << std::endl;
+    }
+
+  int numberOfFailures = failures.fetchAndAddOrdered(0);
+  if(numberOfFailures > 0)
+    {
+    std::cerr << numberOfFailures << " frames could not be written." << std::endl;
+    success = false;
+    }
+  return success;
+}
@@ -0,0 +1,65 @@
+/*
+Copyright (C) 2010 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AnimationExporter_H
+#define AnimationExporter_H
+
+// Custom
+#include "ColorSpaceModel.h"
+
+// STL
+#include <string>
+
+/** Renders the transition between two color spaces offscreen and writes each
+  * frame as a numbered PNG (e.g. frame_0000.png). Frames are rendered as fast as
+  * possible; the PNG encoding of a frame runs on a worker thread while the next
+  * frame renders. VTK uses its software (OSMesa) path for offscreen rendering
+  * when it was built with it, so no display is required.
+  */
+class AnimationExporter
+{
+public:
+  AnimationExporter();
+
+  void SetFrom(ColorSpaceModel::SpaceEnum from);
+  void SetTo(ColorSpaceModel::SpaceEnum to);
+  void SetNumberOfFrames(unsigned int numberOfFrames);
+  void SetSize(int width, int height);
+  void SetOutputPrefix(const std::string& prefix);
+
+  /** Defaults to the number of cores. */
+  void SetNumberOfThreads(int numberOfThreads);
+
+  /** If set, the frame timings are also written to this file in the Chrome trace format.
+    * A summary of them is always printed when profiling is enabled.
+    */
+  void SetTraceFileName(const std::string& fileName);
+
+  /** Returns false if any of the frames (or the trace) could not be written. */
+  bool Export();
+
+protected:
+  ColorSpaceModel::SpaceEnum From;
+  ColorSpaceModel::SpaceEnum To;
+  unsigned int NumberOfFrames;
+  int Size[2];
+  std::string OutputPrefix;
+  int NumberOfThreads;
+  std::string TraceFileName;
+};
+
+#endif
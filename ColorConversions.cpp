@@ -0,0 +1,60 @@
+#include "ColorConversions.h"
+#include "Conversions.h"
+
+extern "C" {
+
+COLORSPACES_API int ColorSpaces_GetAPIVersion(void)
+{
+  return COLORSPACES_API_VERSION;
+}
+
+COLORSPACES_API void ColorSpaces_RGBToHSV(const unsigned char* rgb, size_t count, float* hsv)
+{
+  for(size_t i = 0; i < count; ++i)
+    {
+    float normalized[3] = {rgb[3*i] / 255.0f, rgb[3*i + 1] / 255.0f, rgb[3*i + 2] / 255.0f};
+    RGBtoHSV(normalized, hsv + 3*i);
+    }
+}
+
+COLORSPACES_API void ColorSpaces_RGBToCIELab(const unsigned char* rgb, size_t count, float* cieLab)
+{
+  for(size_t i = 0; i < count; ++i)
+    {
+    unsigned char color[3] = {rgb[3*i], rgb[3*i + 1], rgb[3*i + 2]};
+    RGBtoCIELab(color, cieLab + 3*i);
+    }
+}
+
+COLORSPACES_API size_t ColorSpaces_CIELabToRGB(const float* cieLab, size_t count, unsigned char* rgb,
+                                               int mode, unsigned char* outOfGamut)
+{
+  GamutMappingEnum gamutMapping;
+  switch(mode)
+    {
+    case COLORSPACES_GAMUT_CLIP:
+      gamutMapping = GAMUT_CLIP;
+      break;
+    case COLORSPACES_GAMUT_CHROMA_REDUCTION:
+      gamutMapping = GAMUT_CHROMA_REDUCTION;
+      break;
+    case COLORSPACES_GAMUT_COMPRESSION:
+      gamutMapping = GAMUT_COMPRESSION;
+      break;
+    default:
+      return COLORSPACES_ERROR;
+    }
+
+  // The C++ function counts with unsigned int, so very large buffers are done in chunks
+  const size_t chunkSize = 1 << 20;
+  size_t numberOfOutOfGamut = 0;
+  for(size_t start = 0; start < count; start += chunkSize)
+    {
+    size_t chunk = count - start < chunkSize ? count - start : chunkSize;
+    numberOfOutOfGamut += CIELabtoRGBGamutMapped(cieLab + 3*start, static_cast<unsigned int>(chunk), rgb + 3*start,
+                                                 gamutMapping, outOfGamut ? outOfGamut + start : 0);
+    }
+  return numberOfOutOfGamut;
+}
+
+} // end extern "C"
@@ -0,0 +1,60 @@
+#ifndef ColorConversions_H
+#define ColorConversions_H
+
+/* C interface to the conversions for use from other languages and services.
+ * Every function works on a buffer of 'count' interleaved triplets.
+ *
+ * When the library is built shared (BUILD_SHARED_LIBS), consumers must define
+ * COLORSPACES_SHARED. For a C++ header-only build define COLORSPACES_HEADER_ONLY
+ * instead; Conversions.h, Conversions.cpp and ColorConversions.cpp must then be
+ * next to this file.
+ */
+
+#include <stddef.h>
+
+#include "ColorConversionsExport.h"
+
+#if defined(COLORSPACES_HEADER_ONLY)
+  #define COLORSPACES_API inline
+#else
+  #define COLORSPACES_API COLORSPACES_EXPORT
+#endif
+
+/* Incremented whenever a function is added or changed. */
+#define COLORSPACES_API_VERSION 2
+
+/* Values of the 'mode' argument of ColorSpaces_CIELabToRGB */
+#define COLORSPACES_GAMUT_CLIP 0
+#define COLORSPACES_GAMUT_CHROMA_REDUCTION 1
+#define COLORSPACES_GAMUT_COMPRESSION 2
+
+/* Returned by ColorSpaces_CIELabToRGB for invalid arguments */
+#define COLORSPACES_ERROR ((size_t)-1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+COLORSPACES_API int ColorSpaces_GetAPIVersion(void);
+
+/* h, s and v are in [0,1] */
+COLORSPACES_API void ColorSpaces_RGBToHSV(const unsigned char* rgb, size_t count, float* hsv);
+
+COLORSPACES_API void ColorSpaces_RGBToCIELab(const unsigned char* rgb, size_t count, float* cieLab);
+
+/* 'outOfGamut' may be NULL. Returns the number of colors outside of the sRGB gamut,
+ * or COLORSPACES_ERROR (and converts nothing) if 'mode' is not one of the
+ * COLORSPACES_GAMUT_ values.
+ */
+COLORSPACES_API size_t ColorSpaces_CIELabToRGB(const float* cieLab, size_t count, unsigned char* rgb,
+                                               int mode, unsigned char* outOfGamut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef COLORSPACES_HEADER_ONLY
+  #include "ColorConversions.cpp"
+#endif
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef ColorConversionsExport_H
+#define ColorConversionsExport_H
+
+/* Marks the functions exported by the ColorConversions library, both the C++
+ * ones (Conversions.h) and the C ones (ColorConversions.h). Consumers of a shared
+ * build must define COLORSPACES_SHARED; CMake defines ColorConversions_EXPORTS
+ * while building the library itself.
+ */
+#if defined(COLORSPACES_HEADER_ONLY)
+  #define COLORSPACES_EXPORT
+#elif defined(COLORSPACES_SHARED) && defined(_WIN32)
+  #ifdef ColorConversions_EXPORTS
+    #define COLORSPACES_EXPORT __declspec(dllexport)
+  #else
+    #define COLORSPACES_EXPORT __declspec(dllimport)
+  #endif
+#elif defined(COLORSPACES_SHARED) && defined(__GNUC__)
+  #define COLORSPACES_EXPORT __attribute__((visibility("default")))
+#else
+  #define COLORSPACES_EXPORT
+#endif
+
+#endif
@@ -0,0 +1,367 @@
+/*
+Copyright (C) 2010 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ColorSpaceModel.h"
+#include "Conversions.h"
+#include "Profiler.h"
+
+// VTK
+#include <vtkFloatArray.h>
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+#include <vtkUnsignedCharArray.h>
+
+// STL
+#include <iostream>
+#include <vector>
+
+ColorSpaceModel::ColorSpaceModel(Profiler* profiler, unsigned int spacing) : FrameProfiler(profiler), Spacing(spacing)
+{
+  this->Colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  this->Colors->SetNumberOfComponents(3);
+  this->Colors->SetName ("Colors");
+
+  this->RGBPoints.PolyData->GetPointData()->SetScalars(this->Colors);
+  this->HSVPoints.PolyData->GetPointData()->SetScalars(this->Colors);
+  this->CIELabColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  this->CIELabColors->SetNumberOfComponents(3);
+  this->CIELabColors->SetName ("CIELabColors");
+  this->CIELabPoints.PolyData->GetPointData()->SetScalars(this->CIELabColors);
+
+  CreateColors();
+  SetupRGBCube();
+  SetupHSVCylinder();
+  SetupCIELab();
+  EditCIELab(1.0f, GAMUT_CHROMA_REDUCTION);
+}
+
+DisplayPoints* ColorSpaceModel::GetDisplayPoints(SpaceEnum space)
+{
+  switch(space)
+    {
+    case RGB:
+      return &this->RGBPoints;
+    case HSV:
+      return &this->HSVPoints;
+    case CIELAB:
+    default:
+      return &this->CIELabPoints;
+    }
+}
+
+bool ColorSpaceModel::SpaceFromString(const std::string& name, SpaceEnum& space)
+{
+  if(name == "RGB")
+    {
+    space = RGB;
+    }
+  else if(name == "HSV")
+    {
+    space = HSV;
+    }
+  else if(name == "CIELab")
+    {
+    space = CIELAB;
+    }
+  else
+    {
+    return false;
+    }
+  return true;
+}
+
+void ColorSpaceModel::CreateColors()
+{
+  for(unsigned int r = 0; r < 256; r += this->Spacing)
+    {
+    for(unsigned int g = 0; g < 256; g += this->Spacing)
+      {
+      for(unsigned int b = 0; b < 256; b += this->Spacing)
+        {
+        unsigned char color[3] = {r,g,b};
+        this->Colors->InsertNextTupleValue(color);
+        }
+      }
+    }
+}
+
+void ColorSpaceModel::SetupRGBCube()
+{
+  PROFILE_SCOPE(this->FrameProfiler, "SetupRGBCube");
+
+  this->RGBPoints.Points->Reset();
+  this->RGBPoints.Points->Squeeze();
+  for(unsigned int i = 0 ;i < this->Colors->GetNumberOfTuples(); ++i)
+    {
+    unsigned char color[3];
+    this->Colors->GetTupleValue(i, color);
+    this->RGBPoints.Points->InsertNextPoint(color[0], color[1], color[2]);
+    }
+}
+
+void ColorSpaceModel::SetupCIELab()
+{
+  PROFILE_SCOPE(this->FrameProfiler, "SetupCIELab");
+
+  this->CIELabPoints.Points->Reset();
+  this->CIELabPoints.Points->Squeeze();
+  this->CIELabValues.clear();
+  for(unsigned int i = 0 ;i < this->Colors->GetNumberOfTuples(); ++i)
+    {
+    unsigned char color[3];
+    this->Colors->GetTupleValue(i, color);
+    
+    float cielab[3];
+    RGBtoCIELab(color, cielab);
+
+    //double color_double[3] = {static_cast<float>(color[0])/255.0f, static_cast<float>(color[1])/255.0f, static_cast<float>(color[2])/255.0f};
+    //double cielab[3];
+    //vtkMath::RGBToLab(color_double, cielab);
+
+    float L = cielab[0];
+    float a = cielab[1];
+    float b = cielab[2];
+
+//     float z = v*0.01f; // The spacing of the Z/V slices of the cylinder are way too far apart without this scaling
+//     float x = r*cos(theta * 2.0f * vtkMath::Pi());
+//     float y = r*sin(theta * 2.0f * vtkMath::Pi());
+    float xyz[3] = {L,a,b};
+    this->CIELabPoints.Points->InsertNextPoint(xyz);
+    this->CIELabValues.insert(this->CIELabValues.end(), cielab, cielab + 3);
+    }
+
+  bool fitInRGBCube = false;
+  if(fitInRGBCube)
+    {
+    // Translate and scale the points to they are in the same position and magnitude as the RGB cube
+    double cielabBounds[6];
+    this->CIELabPoints.Points->GetBounds(cielabBounds);
+
+    double rgbBounds[6];
+    this->RGBPoints.Points->GetBounds(rgbBounds);
+
+    OutputBounds("rgbBounds", rgbBounds);
+
+    float scale[3];
+    for(unsigned int i = 0 ; i < 3; ++i)
+      {
+      scale[i] = (rgbBounds[2*i + 1] - rgbBounds[2*i])/(cielabBounds[2*i + 1] - cielabBounds[2*i]);
+      }
+    OutputBounds("cielabBounds", cielabBounds);
+
+    std::cout << "Scale: " << scale[0] << " " << scale[1] << " " << scale[2] << std::endl;
+    
+    vtkSmartPointer<vtkTransform> scaleTransform = vtkSmartPointer<vtkTransform>::New();
+    scaleTransform->Scale(scale);
+    
+    vtkSmartPointer<vtkTransformPolyDataFilter> scaleTransformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    scaleTransformFilter->SetInputData(this->CIELabPoints.PolyData);
+    scaleTransformFilter->SetTransform(scaleTransform);
+    scaleTransformFilter->Update();
+
+    double scaledBounds[6];
+    scaleTransformFilter->GetOutput()->GetBounds(scaledBounds);
+
+    OutputBounds("scaledBounds", scaledBounds);
+    
+    float translation[3];
+    for(unsigned int i = 0 ; i < 3; ++i)
+      {
+      translation[i] = rgbBounds[2*i] - scaledBounds[2*i];
+      }
+      
+    vtkSmartPointer<vtkTransform> translateTransform = vtkSmartPointer<vtkTransform>::New();
+    translateTransform->Translate(translation);
+
+    vtkSmartPointer<vtkTransformPolyDataFilter> translateTransformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    translateTransformFilter->SetInputConnection(scaleTransformFilter->GetOutputPort());
+    translateTransformFilter->SetTransform(translateTransform);
+    translateTransformFilter->Update();
+    
+    std::cout << "translation: " << translation[0] << " " << translation[1] << " " << translation[2] << std::endl;
+
+    this->CIELabPoints.Points->DeepCopy(translateTransformFilter->GetOutput()->GetPoints());
+
+    double newBounds[6];
+    this->CIELabPoints.Points->GetBounds(newBounds);
+    OutputBounds("newBounds", newBounds);
+
+    this->CIELabPoints.Points->Modified();
+    this->CIELabPoints.PolyData->Modified();
+    //transformFilter->RemoveAllInputs();
+    }
+}
+
+void ColorSpaceModel::SetupHSVCylinder()
+{
+  PROFILE_SCOPE(this->FrameProfiler, "SetupHSVCylinder");
+
+  this->HSVPoints.Points->Reset();
+  this->HSVPoints.Points->Squeeze();
+  for(unsigned int i = 0 ;i < this->Colors->GetNumberOfTuples(); ++i)
+    {
+    unsigned char color[3];
+    this->Colors->GetTupleValue(i, color);
+    float floatRGB[3] = {color[0], color[1], color[2]};
+
+    float hsv[3];
+    RGBtoHSV(floatRGB, hsv);
+
+    float h = hsv[0];
+    float s = hsv[1];
+    float v = hsv[2];
+
+    float r = s; // Radius of cylinder
+    float theta = h; // Angle
+
+    float z = v*0.01f; // The spacing of the Z/V slices of the cylinder are way too far apart without this scaling
+    float x = r*cos(theta * 2.0f * vtkMath::Pi());
+    float y = r*sin(theta * 2.0f * vtkMath::Pi());
+    float xyz[3] = {x,y,z};
+    this->HSVPoints.Points->InsertNextPoint(xyz);
+    }
+
+  // Translate and scale the points to they are in the same position and magnitude as the RGB cube
+  double hsvBounds[6];
+  this->HSVPoints.Points->GetBounds(hsvBounds);
+
+  double rgbBounds[6];
+  this->RGBPoints.Points->GetBounds(rgbBounds);
+
+  float translation[3];
+  float scale[3];
+  for(unsigned int i = 0 ; i < 3; ++i)
+    {
+    //scale[i] = (rgbBounds[2*i] - rgbBounds[2*i + 1])/(hsvBounds[2*i] - hsvBounds[2*i + 1]);
+    scale[i] = (rgbBounds[2*i + 1] - rgbBounds[2*i])/(hsvBounds[2*i + 1] - hsvBounds[2*i]);
+    translation[i] = rgbBounds[2*i] - hsvBounds[2*i];
+    }
+//   std::cout  << "xmin: " << bounds[0] << " "
+//              << "xmax: " << bounds[1] << std::endl
+//              << "ymin: " << bounds[2] << " "
+//              << "ymax: " << bounds[3] << std::endl
+//              << "zmin: " << bounds[4] << " "
+//              << "zmax: " << bounds[5] << std::endl;
+
+  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
+  transform->Scale(scale);
+  transform->Translate(translation);
+
+  vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  transformFilter->SetInputData(this->HSVPoints.PolyData);
+  transformFilter->SetTransform(transform);
+  transformFilter->Update();
+
+  this->HSVPoints.Points->DeepCopy(transformFilter->GetOutput()->GetPoints());
+  
+  this->HSVPoints.Points->Modified();
+  this->HSVPoints.PolyData->Modified();
+  transformFilter->RemoveAllInputs();
+}
+
+unsigned int ColorSpaceModel::EditCIELab(float chromaScale, GamutMappingEnum mode)
+{
+  PROFILE_SCOPE(this->FrameProfiler, "EditCIELab");
+
+  unsigned int numberOfColors = this->CIELabValues.size() / 3;
+  this->CIELabColors->SetNumberOfTuples(numberOfColors);
+  if(numberOfColors == 0)
+    {
+    return 0;
+    }
+
+  std::vector<float> edited(this->CIELabValues.size());
+  for(unsigned int i = 0; i < numberOfColors; ++i)
+    {
+    edited[3*i] = this->CIELabValues[3*i];
+    edited[3*i + 1] = this->CIELabValues[3*i + 1] * chromaScale;
+    edited[3*i + 2] = this->CIELabValues[3*i + 2] * chromaScale;
+    }
+
+  // The mapping and the out-of-gamut classification are done in the same pass
+  std::vector<unsigned char> mapped(3 * numberOfColors);
+  std::vector<unsigned char> outOfGamut(numberOfColors);
+  unsigned int numberOfOutOfGamut = CIELabtoRGBGamutMapped(&edited[0], numberOfColors, &mapped[0], mode, &outOfGamut[0]);
+
+  // Show the mapped color, tinted towards magenta if the edited color was not displayable
+  const unsigned char tint[3] = {255, 0, 255};
+  unsigned char* colors = this->CIELabColors->GetPointer(0);
+  for(unsigned int i = 0; i < 3 * numberOfColors; ++i)
+    {
+    colors[i] = outOfGamut[i/3] ? (mapped[i] + tint[i%3]) / 2 : mapped[i];
+    }
+  this->CIELabColors->Modified();
+
+  for(unsigned int i = 0; i < numberOfColors; ++i)
+    {
+    this->CIELabPoints.Points->SetPoint(i, &edited[3*i]);
+    }
+  this->CIELabPoints.Points->Modified();
+
+  return numberOfOutOfGamut;
+}
+
+void ColorSpaceModel::Interpolate(vtkPoints* current, vtkPoints* next, float transition, vtkPoints* output)
+{
+  vtkIdType numberOfPoints = current->GetNumberOfPoints();
+  if(output->GetNumberOfPoints() != numberOfPoints)
+    {
+    output->SetNumberOfPoints(numberOfPoints);
+    }
+
+  // All of the point sets are created with the default float storage, so in practice
+  // this works directly on the arrays instead of going through GetPoint/SetPoint.
+  if(current->GetDataType() == VTK_FLOAT && next->GetDataType() == VTK_FLOAT && output->GetDataType() == VTK_FLOAT)
+    {
+    const float* currentData = static_cast<vtkFloatArray*>(current->GetData())->GetPointer(0);
+    const float* nextData = static_cast<vtkFloatArray*>(next->GetData())->GetPointer(0);
+    float* outputData = static_cast<vtkFloatArray*>(output->GetData())->GetPointer(0);
+    for(vtkIdType i = 0; i < 3 * numberOfPoints; ++i)
+      {
+      outputData[i] = currentData[i] + (nextData[i] - currentData[i]) * transition;
+      }
+    return;
+    }
+
+  for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    double newPoint[3];
+    double currentPoint[3];
+    current->GetPoint(pointId, currentPoint);
+    double nextPoint[3];
+    next->GetPoint(pointId, nextPoint);
+    for(unsigned int component = 0; component < 3; component++)
+      {
+      newPoint[component] = currentPoint[component] + (nextPoint[component] - currentPoint[component]) * transition;
+      }
+    output->SetPoint(pointId, newPoint);
+    }
+}
+
+void OutputBounds(const std::string& name, double bounds[6])
+{
+  std::cout << name << " xmin: " << bounds[0] << " "
+            << name << " xmax: " << bounds[1] << std::endl
+            << name << " ymin: " << bounds[2] << " "
+            << name << " ymax: " << bounds[3] << std::endl
+            << name << " zmin: " << bounds[4] << " "
+            << name << " zmax: " << bounds[5] << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+Copyright (C) 2010 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ColorSpaceModel_H
+#define ColorSpaceModel_H
+
+// Custom
+#include "Conversions.h"
+#include "DisplayPoints.h"
+
+// VTK
+#include <vtkSmartPointer.h>
+
+// STL
+#include <string>
+#include <vector>
+
+// Forward declarations
+class Profiler;
+class vtkPoints;
+class vtkUnsignedCharArray;
+
+/** The sampled RGB colors and their positions in each of the color spaces.
+  * This does not depend on the GUI so it can also drive the headless export.
+  */
+class ColorSpaceModel
+{
+public:
+  enum SpaceEnum {RGB, HSV, CIELAB};
+
+  ColorSpaceModel(Profiler* profiler, unsigned int spacing = 10);
+
+  DisplayPoints* GetDisplayPoints(SpaceEnum space);
+
+  /** Accepts "RGB", "HSV" or "CIELab". */
+  static bool SpaceFromString(const std::string& name, SpaceEnum& space);
+
+  /** Scale the chroma (a and b) of the CIELab points and map the result back to sRGB
+    * to color them. Colors that fall outside of the gamut are tinted magenta.
+    * Returns the number of out-of-gamut colors.
+    */
+  unsigned int EditCIELab(float chromaScale, GamutMappingEnum mode);
+
+  /** output = current + (next - current) * transition */
+  static void Interpolate(vtkPoints* current, vtkPoints* next, float transition, vtkPoints* output);
+
+  DisplayPoints RGBPoints;
+  DisplayPoints HSVPoints;
+  DisplayPoints CIELabPoints;
+
+  vtkSmartPointer<vtkUnsignedCharArray> Colors;
+
+  // The gamut mapped (and possibly tinted) colors of the edited CIELab points
+  vtkSmartPointer<vtkUnsignedCharArray> CIELabColors;
+
+protected:
+  void CreateColors();
+
+  void SetupRGBCube();
+  void SetupHSVCylinder();
+  void SetupCIELab();
+
+  // The unedited L, a, b of each color
+  std::vector<float> CIELabValues;
+
+  Profiler* FrameProfiler;
+
+  unsigned int Spacing;
+};
+
+void OutputBounds(const std::string& name, double bounds[6]);
+
+#endif
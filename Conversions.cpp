@@ -2,9 +2,48 @@
 
 #include <algorithm> // min,max
 #include <cmath>
-#include <iostream>
 
-void RGBtoCIELab(unsigned char rgb[3], float cieLab[3])
+COLORSPACES_INLINE void RGBtoHSV(const float rgb[3], float hsv[3])
+{
+  const float red = rgb[0];
+  const float green = rgb[1];
+  const float blue = rgb[2];
+
+  float cmax = std::max(red, std::max(green, blue));
+  float cmin = std::min(red, std::min(green, blue));
+
+  hsv[2] = cmax; // v
+  hsv[1] = cmax > 0.0f ? (cmax - cmin) / cmax : 0.0f; // s
+
+  if(hsv[1] <= 0.0f)
+    {
+    hsv[0] = 0.0f;
+    return;
+    }
+
+  float delta = cmax - cmin;
+  float h;
+  if(red == cmax)
+    {
+    h = (green - blue) / delta / 6.0f;
+    }
+  else if(green == cmax)
+    {
+    h = 1.0f/3.0f + (blue - red) / delta / 6.0f;
+    }
+  else
+    {
+    h = 2.0f/3.0f + (red - green) / delta / 6.0f;
+    }
+
+  if(h < 0.0f)
+    {
+    h += 1.0f;
+    }
+  hsv[0] = h;
+}
+
+COLORSPACES_INLINE void RGBtoCIELab(unsigned char rgb[3], float cieLab[3])
 {
   // The input RGB must be between [0,255]
   // The output should be between [0, 100]
@@ -82,11 +121,288 @@ void RGBtoCIELab(unsigned char rgb[3], float cieLab[3])
   cieLab[0] = (116.0 * Y2) - 16.0; // L
   cieLab[1] = 500.0 * (X2 - Y2); // a
   cieLab[2] = 200.0 * (Y2 - Z2); // b
-  
-  if(cieLab[0] < 0 || cieLab[0] > 100 || cieLab[1] < 0 || cieLab[1] > 100 || cieLab[2] < 0 || cieLab[2] > 100)
+}
+
+// The gamut mapping works on blocks of colors in structure-of-arrays form. Every
+// step is a fixed-length loop over the block with no data dependent branches (the
+// bisections always run the same number of iterations and the results are chosen with
+// selects), so the compiler can vectorize the loops. That needs optimization (-O3, the
+// Release default) and -fno-math-errno for std::sqrt; check with -fopt-info-vec.
+// The helpers are in a named namespace and marked COLORSPACES_INLINE like the rest of
+// this file, so that in the header-only mode they neither clash with the includer's
+// names nor break the one definition rule.
+namespace ColorSpacesInternal
+{
+
+const unsigned int BlockSize = 64;
+const unsigned int BisectionIterations = 16;
+
+/** Three channels (L,a,b or linear R,G,B) of a block of colors. Keeping the channels in
+  * one object lets the compiler see that they don't overlap; with six separate pointers
+  * it needs more run-time alias checks than it is willing to emit and gives up.
+  */
+struct ColorBlock
+{
+  float Channel[3][BlockSize];
+};
+
+/** Branch-free 'condition ? whenTrue : whenFalse' for finite values. GCC does not if-convert
+  * a ?: on floats under the default -ftrapping-math, and can't vectorize a bool to float
+  * conversion, so the mask goes through an int.
+  */
+inline float Select(bool condition, float whenTrue, float whenFalse)
+{
+  int flag = condition;
+  float mask = static_cast<float>(flag);
+  return mask * whenTrue + (1.0f - mask) * whenFalse;
+}
+
+inline float LabInverseCompand(float t)
+{
+  float cube = t * t * t;
+  float linear = (t - 16.0f/116.0f) * (1.0f/7.787f);
+  return Select(t > 6.0f/29.0f, cube, linear);
+}
+
+inline float SRGBCompand(float c)
+{
+  return c <= 0.0031308f ? 12.92f * c : 1.055f * std::pow(c, 1.0f/2.4f) - 0.055f;
+}
+
+/** CIELab to linear RGB in [0,1] for the first 'count' colors of a block. */
+COLORSPACES_INLINE void LabToLinearRGB(const ColorBlock& lab, unsigned int count, ColorBlock& linearRGB)
+{
+  const float* L = lab.Channel[0];
+  const float* a = lab.Channel[1];
+  const float* b = lab.Channel[2];
+  float* red = linearRGB.Channel[0];
+  float* green = linearRGB.Channel[1];
+  float* blue = linearRGB.Channel[2];
+
+  for(unsigned int i = 0; i < count; ++i)
+    {
+    float fy = (L[i] + 16.0f) * (1.0f/116.0f);
+    float fx = fy + a[i] * (1.0f/500.0f);
+    float fz = fy - b[i] * (1.0f/200.0f);
+
+    float X = 0.95047f * LabInverseCompand(fx);
+    float Y = LabInverseCompand(fy);
+    float Z = 1.08883f * LabInverseCompand(fz);
+
+    red[i] = 3.2406f * X - 1.5372f * Y - 0.4986f * Z;
+    green[i] = -0.9689f * X + 1.8758f * Y + 0.0415f * Z;
+    blue[i] = 0.0557f * X - 0.2040f * Y + 1.0570f * Z;
+    }
+}
+
+inline bool InGamut(float red, float green, float blue)
+{
+  // Allow for the rounding error of a round trip from 8-bit RGB
+  const float lower = -1.0e-3f;
+  const float upper = 1.0f + 1.0e-3f;
+  return (red >= lower) & (red <= upper) & (green >= lower) & (green <= upper) & (blue >= lower) & (blue <= upper);
+}
+
+/** For each color find the largest chroma in [0, upper[i]] along its hue at its L that
+  * is still in gamut. 'directionA'/'directionB' are the unit hue directions.
+  */
+COLORSPACES_INLINE void FindBoundaryChroma(const float* L, const float* directionA, const float* directionB,
+                                           const float* upper, unsigned int count, float* boundary)
+{
+  float low[BlockSize];
+  float high[BlockSize];
+  ColorBlock lab;
+  ColorBlock linearRGB;
+
+  for(unsigned int i = 0; i < count; ++i)
+    {
+    low[i] = 0.0f;
+    high[i] = upper[i];
+    lab.Channel[0][i] = L[i];
+    }
+
+  for(unsigned int iteration = 0; iteration < BisectionIterations; ++iteration)
+    {
+    for(unsigned int i = 0; i < count; ++i)
+      {
+      float middle = 0.5f * (low[i] + high[i]);
+      lab.Channel[1][i] = middle * directionA[i];
+      lab.Channel[2][i] = middle * directionB[i];
+      }
+    LabToLinearRGB(lab, count, linearRGB);
+    for(unsigned int i = 0; i < count; ++i)
+      {
+      float middle = 0.5f * (low[i] + high[i]);
+      bool inside = InGamut(linearRGB.Channel[0][i], linearRGB.Channel[1][i], linearRGB.Channel[2][i]);
+      low[i] = Select(inside, middle, low[i]);
+      high[i] = Select(inside, high[i], middle);
+      }
+    }
+
+  // If the upper limit itself is in gamut, the bisection converges to it
+  for(unsigned int i = 0; i < count; ++i)
+    {
+    boundary[i] = low[i];
+    }
+}
+
+COLORSPACES_INLINE void MapBlock(const float* cieLab, unsigned int count, unsigned char* rgb, GamutMappingEnum mode,
+                                 unsigned char* outOfGamut, unsigned int& numberOfOutOfGamut)
+{
+  // Zeroed because GCC can't tell that only the first 'count' colors are read
+  ColorBlock lab = ColorBlock();
+  ColorBlock linearRGB;
+  unsigned char outside[BlockSize];
+  float* L = lab.Channel[0];
+  float* a = lab.Channel[1];
+  float* b = lab.Channel[2];
+
+  for(unsigned int i = 0; i < count; ++i)
+    {
+    L[i] = cieLab[3*i];
+    a[i] = cieLab[3*i + 1];
+    b[i] = cieLab[3*i + 2];
+    }
+
+  LabToLinearRGB(lab, count, linearRGB);
+
+  unsigned int blockOutside = 0;
+  for(unsigned int i = 0; i < count; ++i)
+    {
+    bool lightnessInRange = (L[i] >= 0.0f) & (L[i] <= 100.0f);
+    outside[i] = !(lightnessInRange & InGamut(linearRGB.Channel[0][i], linearRGB.Channel[1][i], linearRGB.Channel[2][i]));
+    blockOutside += outside[i];
+    }
+  numberOfOutOfGamut += blockOutside;
+
+  bool remap = (mode == GAMUT_COMPRESSION) || (mode == GAMUT_CHROMA_REDUCTION && blockOutside > 0);
+  if(remap)
+    {
+    float chroma[BlockSize];
+    float directionA[BlockSize];
+    float directionB[BlockSize];
+    float upper[BlockSize];
+    float boundary[BlockSize];
+    const bool searchToMaximum = (mode == GAMUT_COMPRESSION);
+    // The largest chroma searched for the gamut boundary. sRGB has no chroma above ~134.
+    const float maximumChroma = 200.0f;
+    for(unsigned int i = 0; i < count; ++i)
+      {
+      // Mapping is done at constant L, so L must first be brought into range
+      L[i] = std::min(100.0f, std::max(0.0f, L[i]));
+      chroma[i] = std::sqrt(a[i] * a[i] + b[i] * b[i]);
+      float inverseChroma = Select(chroma[i] > 0.0f, 1.0f / (chroma[i] + 1.0e-30f), 0.0f);
+      directionA[i] = a[i] * inverseChroma;
+      directionB[i] = b[i] * inverseChroma;
+      upper[i] = Select(searchToMaximum, maximumChroma, chroma[i]);
+      }
+
+    FindBoundaryChroma(L, directionA, directionB, upper, count, boundary);
+
+    float newChroma[BlockSize];
+    if(mode == GAMUT_COMPRESSION)
+      {
+      // Identity up to the knee, then approach the boundary asymptotically. std::exp is
+      // a library call, so it gets its own (scalar) loop.
+      float exponent[BlockSize];
+      for(unsigned int i = 0; i < count; ++i)
+        {
+        float knee = 0.8f * boundary[i];
+        float range = boundary[i] - knee;
+        exponent[i] = -std::max(chroma[i] - knee, 0.0f) / std::max(range, 1.0e-6f);
+        }
+      for(unsigned int i = 0; i < count; ++i)
+        {
+        exponent[i] = std::exp(exponent[i]);
+        }
+      for(unsigned int i = 0; i < count; ++i)
+        {
+        float knee = 0.8f * boundary[i];
+        float compressed = knee + (boundary[i] - knee) * (1.0f - exponent[i]);
+        newChroma[i] = Select(chroma[i] <= knee, chroma[i], compressed);
+        }
+      }
+    else
+      {
+      for(unsigned int i = 0; i < count; ++i)
+        {
+        newChroma[i] = boundary[i];
+        }
+      }
+
+    for(unsigned int i = 0; i < count; ++i)
+      {
+      a[i] = newChroma[i] * directionA[i];
+      b[i] = newChroma[i] * directionB[i];
+      }
+
+    LabToLinearRGB(lab, count, linearRGB);
+    }
+
+  // Clip whatever is left (everything for GAMUT_CLIP, only rounding error otherwise)
+  ColorBlock clipped;
+  for(unsigned int i = 0; i < count; ++i)
+    {
+    clipped.Channel[0][i] = std::min(1.0f, std::max(0.0f, linearRGB.Channel[0][i]));
+    clipped.Channel[1][i] = std::min(1.0f, std::max(0.0f, linearRGB.Channel[1][i]));
+    clipped.Channel[2][i] = std::min(1.0f, std::max(0.0f, linearRGB.Channel[2][i]));
+    }
+
+  // std::pow is a library call, so the companding is kept in its own (scalar) loop,
+  // which also interleaves the channels
+  float companded[3 * BlockSize];
+  for(unsigned int i = 0; i < count; ++i)
+    {
+    for(unsigned int component = 0; component < 3; ++component)
+      {
+      companded[3*i + component] = SRGBCompand(clipped.Channel[component][i]);
+      }
+    }
+
+  for(unsigned int i = 0; i < 3 * count; ++i)
+    {
+    rgb[i] = static_cast<unsigned char>(companded[i] * 255.0f + 0.5f);
+    }
+
+  if(outOfGamut)
+    {
+    for(unsigned int i = 0; i < count; ++i)
+      {
+      outOfGamut[i] = outside[i];
+      }
+    }
+}
+
+} // end namespace ColorSpacesInternal
+
+COLORSPACES_INLINE void CIELabtoRGB(const float cieLab[3], float rgb[3])
+{
+  ColorSpacesInternal::ColorBlock lab;
+  ColorSpacesInternal::ColorBlock linearRGB;
+  for(unsigned int component = 0; component < 3; ++component)
+    {
+    lab.Channel[component][0] = cieLab[component];
+    }
+  ColorSpacesInternal::LabToLinearRGB(lab, 1, linearRGB);
+
+  // Companding is odd-symmetric so that out-of-gamut values stay out of [0,255]
+  for(unsigned int component = 0; component < 3; ++component)
+    {
+    float channel = linearRGB.Channel[component][0];
+    float sign = channel < 0.0f ? -1.0f : 1.0f;
+    rgb[component] = sign * ColorSpacesInternal::SRGBCompand(sign * channel) * 255.0f;
+    }
+}
+
+COLORSPACES_INLINE unsigned int CIELabtoRGBGamutMapped(const float* cieLab, unsigned int numberOfColors, unsigned char* rgb,
+                                    GamutMappingEnum mode, unsigned char* outOfGamut)
+{
+  const unsigned int blockSize = ColorSpacesInternal::BlockSize;
+  unsigned int numberOfOutOfGamut = 0;
+  for(unsigned int start = 0; start < numberOfColors; start += blockSize)
     {
-    std::cout << "Something is wrong!" << std::endl;
-    std::cout << "RGB " << rgb[0] << " " << rgb[1] << " " << rgb[2] << std::endl;
-    std::cout << "LAB " << cieLab[0] << " " << cieLab[1] << " " << cieLab[2] << std::endl;
+    unsigned int count = std::min(blockSize, numberOfColors - start);
+    ColorSpacesInternal::MapBlock(cieLab + 3*start, count, rgb + 3*start, mode, outOfGamut ? outOfGamut + start : 0, numberOfOutOfGamut);
     }
+  return numberOfOutOfGamut;
 }
@@ -1,7 +1,46 @@
 #ifndef Conversions_H
 #define Conversions_H
 
+// The conversions only use the standard library. They are built as the ColorConversions
+// library, or can be used header-only by defining COLORSPACES_HEADER_ONLY before
+// including this file, in which case Conversions.cpp must be next to it.
+#ifdef COLORSPACES_HEADER_ONLY
+  #define COLORSPACES_INLINE inline
+#else
+  #define COLORSPACES_INLINE
+#endif
+
+#include "ColorConversionsExport.h"
+
+/** Same convention as vtkMath::RGBToHSV: h, s and v are in [0,1] for rgb in [0,1]
+  * (v has the scale of the input otherwise).
+  */
+COLORSPACES_EXPORT void RGBtoHSV(const float rgb[3], float hsv[3]);
+
+COLORSPACES_EXPORT void RGBtoCIELab(unsigned char rgb[3], float cieLab[3]);
 
-void RGBtoCIELab(unsigned char rgb[3], float cieLab[3]);
+/** The inverse of RGBtoCIELab. The output is in [0,255] but is not clamped, so
+  * colors outside of the sRGB gamut have components outside of that range.
+  */
+COLORSPACES_EXPORT void CIELabtoRGB(const float cieLab[3], float rgb[3]);
+
+/** How CIELabtoRGBGamutMapped brings out-of-gamut colors into sRGB.
+  * CLIP: clamp each linear RGB channel. Cheap, but shifts the hue.
+  * CHROMA_REDUCTION: reduce the chroma at constant L and hue until the color is in gamut.
+  * COMPRESSION: smoothly compress the chroma of every color above 80% of the gamut
+  *              boundary at its L and hue, so that out-of-gamut colors keep their order.
+  */
+enum GamutMappingEnum {GAMUT_CLIP, GAMUT_CHROMA_REDUCTION, GAMUT_COMPRESSION};
+
+/** Convert 'numberOfColors' CIELab triplets to 8-bit RGB triplets. If 'outOfGamut'
+  * is not null it is set to 1 for each color outside of the sRGB gamut and 0 otherwise.
+  * Returns the number of colors that were outside of the gamut.
+  */
+COLORSPACES_EXPORT unsigned int CIELabtoRGBGamutMapped(const float* cieLab, unsigned int numberOfColors, unsigned char* rgb,
+                                                       GamutMappingEnum mode, unsigned char* outOfGamut = 0);
+
+#ifdef COLORSPACES_HEADER_ONLY
+  #include "Conversions.cpp"
+#endif
 
 #endif
@@ -22,4 +22,6 @@ DisplayPoints::DisplayPoints()
 
   this->Mapper->SetInputConnection(this->VertexGlyphFilter->GetOutputPort());
   this->Actor->SetMapper(this->Mapper);
+
+  this->Locator.SetPoints(this->Points);
 }
@@ -2,6 +2,10 @@
 #ifndef DisplayPoints_H
 #define DisplayPoints_H
 
+// Custom
+#include "PointLocator.h"
+
+// VTK
 #include <vtkSmartPointer.h>
 
 // Forward declarations
@@ -20,6 +24,9 @@ public:
   vtkSmartPointer<vtkVertexGlyphFilter> VertexGlyphFilter;
   vtkSmartPointer<vtkPolyDataMapper> Mapper;
   vtkSmartPointer<vtkActor> Actor;
+
+  // Rebuilds itself when Points is modified
+  PointLocator Locator;
 };
 
 #endif
@@ -3,31 +3,230 @@
 // VTK
 #include <vtkPolyData.h>
 
+// STL
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace Helpers
 {
 
+namespace Internal
+{
+
+/** Copies the first min(TInputComponents, TOutputComponents) channels of each of the 'width'
+  * pixels and sets any additional output channel to 'fill'. The strides are compile time
+  * constants so the loop is vectorized into shuffles instead of running per pixel.
+  */
+template <int TInputComponents, int TOutputComponents>
+void RepackRow(const unsigned char* input, unsigned char* output, int width, unsigned char fill)
+{
+  const int copied = TInputComponents < TOutputComponents ? TInputComponents : TOutputComponents;
+  for(int x = 0; x < width; ++x)
+    {
+    for(int component = 0; component < copied; ++component)
+      {
+      output[TOutputComponents * x + component] = input[TInputComponents * x + component];
+      }
+    for(int component = copied; component < TOutputComponents; ++component)
+      {
+      output[TOutputComponents * x + component] = fill;
+      }
+    }
+}
+
+/** Storing every third byte needs a byte shuffle (SSSE3), so with plain SSE2 the compiler
+  * leaves the loop above scalar for 4 to 3 components. This packs four pixels at a time with
+  * SSE2 shifts and masks instead.
+  */
+template <>
+void RepackRow<4, 3>(const unsigned char* input, unsigned char* output, int width, unsigned char)
+{
+  int x = 0;
+#ifdef __SSE2__
+  const __m128i lowPixel = _mm_set1_epi64x(0x0000000000FFFFFFLL);
+  const __m128i highPixel = _mm_set1_epi64x(0x0000FFFFFF000000LL);
+  const __m128i lowHalf = _mm_set_epi64x(0, -1);
+  for(; x + 4 <= width; x += 4)
+    {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 4*x));
+    // Two pixels in each 64-bit half: drop the alpha of both and close the gap between them
+    __m128i halves = _mm_or_si128(_mm_and_si128(pixels, lowPixel), _mm_and_si128(_mm_srli_epi64(pixels, 8), highPixel));
+    // Then close the gap between the halves, leaving the 12 bytes at the bottom
+    __m128i packed = _mm_or_si128(_mm_and_si128(halves, lowHalf), _mm_srli_si128(_mm_andnot_si128(lowHalf, halves), 2));
+    // Only 12 bytes are stored, a 16 byte store could write past the end of the row
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 3*x), packed);
+    int last = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+    std::memcpy(output + 3*x + 8, &last, 4);
+    }
+#endif
+  for(; x < width; ++x)
+    {
+    output[3*x] = input[4*x];
+    output[3*x + 1] = input[4*x + 1];
+    output[3*x + 2] = input[4*x + 2];
+    }
+}
+
+/** Blends 'width' RGBA foreground pixels over RGBA background pixels. 'output' may be 'background'. */
+void BlendRow(const unsigned char* foreground, const unsigned char* background, unsigned char* output, int width)
+{
+  for(int x = 0; x < width; ++x)
+    {
+    // Integer arithmetic rounded to nearest, so the compiler can vectorize the loop
+    const unsigned int alpha = foreground[4*x + 3];
+    const unsigned int inverseAlpha = 255 - alpha;
+    for(int component = 0; component < 3; ++component)
+      {
+      output[4*x + component] = static_cast<unsigned char>((foreground[4*x + component] * alpha + background[4*x + component] * inverseAlpha + 127) / 255);
+      }
+    // Porter-Duff "over" for the alpha channel
+    output[4*x + 3] = static_cast<unsigned char>(alpha + (background[4*x + 3] * inverseAlpha + 127) / 255);
+    }
+}
+
+/** Blends an RGBA foreground over a background with 'TBackgroundComponents' components. */
+template <int TBackgroundComponents>
+struct BlendFunctor
+{
+  ImageView<unsigned char> Foreground;
+  ImageView<unsigned char> Background;
+  ImageView<unsigned char> Output;
+
+  BlendFunctor(vtkImageData* foreground, vtkImageData* background, vtkImageData* output) :
+    Foreground(foreground), Background(background), Output(output) {}
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const int width = this->Foreground.GetWidth();
+    for(vtkIdType row = begin; row < end; ++row)
+      {
+      const unsigned char* foreground = this->Foreground.GetRow(row);
+      const unsigned char* background = this->Background.GetRow(row);
+      unsigned char* output = this->Output.GetRow(row);
+      if(TBackgroundComponents == 4)
+        {
+        BlendRow(foreground, background, output, width);
+        continue;
+        }
+
+      // An RGB background is blended in chunks through RGBA, so every step has
+      // power of two strides (or is RepackRow<4, 3>) and is vectorized
+      const int chunkSize = 256;
+      unsigned char chunk[4 * chunkSize];
+      for(int x = 0; x < width; x += chunkSize)
+        {
+        int count = std::min(chunkSize, width - x);
+        RepackRow<3, 4>(background + 3*x, chunk, count, 255);
+        BlendRow(foreground + 4*x, chunk, chunk, count);
+        RepackRow<4, 3>(chunk, output + 3*x, count, 0);
+        }
+      }
+  }
+};
+
+template <int TInputComponents, int TOutputComponents>
+struct RepackFunctor
+{
+  ImageView<unsigned char> Input;
+  ImageView<unsigned char> Output;
+  unsigned char Fill;
+
+  RepackFunctor(vtkImageData* input, vtkImageData* output, unsigned char fill) : Input(input), Output(output), Fill(fill) {}
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const int width = this->Input.GetWidth();
+    for(vtkIdType row = begin; row < end; ++row)
+      {
+      RepackRow<TInputComponents, TOutputComponents>(this->Input.GetRow(row), this->Output.GetRow(row), width, this->Fill);
+      }
+  }
+};
+
+template <int TInputComponents, int TOutputComponents>
+void Repack(vtkImageData* input, vtkImageData* output, unsigned char fill)
+{
+  if(input->GetNumberOfScalarComponents() != TInputComponents || input->GetScalarType() != VTK_UNSIGNED_CHAR)
+    {
+    std::cerr << "Repack: the input must be an unsigned char image with " << TInputComponents << " components." << std::endl;
+    return;
+    }
+  if(output == input)
+    {
+    std::cerr << "Repack: the output must be a different image than the input." << std::endl;
+    return;
+    }
+
+  AllocateLike<unsigned char>(input, output, TOutputComponents);
+
+  RepackFunctor<TInputComponents, TOutputComponents> functor(input, output, fill);
+  vtkSMPTools::For(0, functor.Input.GetNumberOfRows(), functor);
+}
+
+} // end namespace Internal
+
+void AlphaComposite(vtkImageData* foreground, vtkImageData* background, vtkImageData* output)
+{
+  int backgroundComponents = background->GetNumberOfScalarComponents();
+  if(foreground->GetNumberOfScalarComponents() != 4 || (backgroundComponents != 3 && backgroundComponents != 4))
+    {
+    std::cerr << "AlphaComposite: the foreground must be RGBA and the background RGB or RGBA." << std::endl;
+    return;
+    }
+  if(foreground->GetScalarType() != VTK_UNSIGNED_CHAR || background->GetScalarType() != VTK_UNSIGNED_CHAR)
+    {
+    std::cerr << "AlphaComposite: the foreground and background must be unsigned char images." << std::endl;
+    return;
+    }
+  if(!Internal::HaveSameDimensions(foreground, background))
+    {
+    std::cerr << "AlphaComposite: the foreground and background must have the same dimensions." << std::endl;
+    return;
+    }
+  if(output == foreground)
+    {
+    std::cerr << "AlphaComposite: the output can be the background but not the foreground." << std::endl;
+    return;
+    }
+
+  Internal::AllocateLike<unsigned char>(background, output, backgroundComponents);
+  if(backgroundComponents == 3)
+    {
+    Internal::BlendFunctor<3> functor(foreground, background, output);
+    vtkSMPTools::For(0, functor.Foreground.GetNumberOfRows(), functor);
+    }
+  else
+    {
+    Internal::BlendFunctor<4> functor(foreground, background, output);
+    vtkSMPTools::For(0, functor.Foreground.GetNumberOfRows(), functor);
+    }
+}
+
+void RGBAToRGB(vtkImageData* input, vtkImageData* output)
+{
+  Internal::Repack<4, 3>(input, output, 0);
+}
+
+void RGBToRGBA(vtkImageData* input, vtkImageData* output, unsigned char alpha)
+{
+  Internal::Repack<3, 4>(input, output, alpha);
+}
+
 void CreateTransparentImage(vtkImageData* input, vtkImageData* output)
 {
   int* dims = input->GetDimensions();
   output->SetDimensions(dims); 
   output->AllocateScalars(VTK_UNSIGNED_CHAR,4);
-  
-  for (int y = 0; y < dims[1]; y++)
-    {
-    for (int x = 0; x < dims[0]; x++)
-      {
-      unsigned char* outputPixel = static_cast<unsigned char*>(output->GetScalarPointer(x,y,0));
-      unsigned char color = 255;
-      outputPixel[0] = color;
-      outputPixel[1] = color;
-      outputPixel[2] = color;
-
-      //outputPixel[3] = 0; // transparent
-      outputPixel[3] = 100; // opaque
-      //outputPixel[3] = 255; // opaque
-      
-      } // end x loop
-    } // end y loop
+
+  //const unsigned char pixel[4] = {255, 255, 255, 0}; // transparent
+  const unsigned char pixel[4] = {255, 255, 255, 100}; // opaque
+  //const unsigned char pixel[4] = {255, 255, 255, 255}; // opaque
+  ParallelFill(output, pixel);
 }
 
 
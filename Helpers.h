@@ -11,6 +11,59 @@ class vtkPolyData;
 namespace Helpers
 {
 
+/** Typed view of the scalars of an image as a sequence of rows. A row is one
+  * scanline (all x for a fixed y and z), so row 'i' is y = i % height, z = i / height.
+  * The scalars of a vtkImageData are contiguous, so this only computes the
+  * address of each row once instead of calling GetScalarPointer for every pixel.
+  * An image whose scalar type isn't T gives an empty view (and an error message).
+  */
+template <typename T>
+class ImageView
+{
+public:
+  ImageView(vtkImageData* image);
+
+  T* GetRow(vtkIdType row) const;
+
+  vtkIdType GetNumberOfRows() const;
+  int GetWidth() const;
+  int GetNumberOfComponents() const;
+
+  /** Number of values (not pixels) in a row. */
+  vtkIdType GetRowLength() const;
+
+private:
+  T* Data;
+  int Width;
+  int NumberOfComponents;
+  vtkIdType NumberOfRows;
+};
+
+/** Set every pixel to 'pixel', which has one value per component. The rows are split across threads. */
+template <typename T>
+void ParallelFill(vtkImageData* image, const T* pixel);
+
+/** output(x) = functor(input(x)). The functor is called as functor(const TInput* inputPixel, TOutput* outputPixel).
+  * 'output' is allocated with 'numberOfOutputComponents' components unless it is 'input' itself.
+  */
+template <typename TInput, typename TOutput, typename TFunctor>
+void ParallelMap(vtkImageData* input, vtkImageData* output, int numberOfOutputComponents, TFunctor functor);
+
+/** output(x) = functor(inputA(x), inputB(x)). The inputs must have the same dimensions.
+  * The functor is called as functor(const TInputA* pixelA, const TInputB* pixelB, TOutput* outputPixel).
+  */
+template <typename TInputA, typename TInputB, typename TOutput, typename TFunctor>
+void ParallelZip(vtkImageData* inputA, vtkImageData* inputB, vtkImageData* output, int numberOfOutputComponents, TFunctor functor);
+
+/** Blend an unsigned char RGBA 'foreground' over an unsigned char RGB or RGBA 'background'
+  * of the same dimensions. The output has the same number of components as the background and may be the background itself.
+  */
+void AlphaComposite(vtkImageData* foreground, vtkImageData* background, vtkImageData* output);
+
+/** Repack unsigned char images between 4 and 3 components. */
+void RGBAToRGB(vtkImageData* input, vtkImageData* output);
+void RGBToRGBA(vtkImageData* input, vtkImageData* output, unsigned char alpha = 255);
+
 void CreateTransparentImage(vtkImageData* input, vtkImageData* output);
 
 
@@ -18,4 +71,6 @@ void OutputImageSize(vtkImageData* image);
 
 }
 
+#include "Helpers.hpp"
+
 #endif
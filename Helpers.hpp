@@ -0,0 +1,239 @@
+// VTK
+#include <vtkSMPTools.h>
+#include <vtkTypeTraits.h>
+
+// STL
+#include <iostream>
+
+namespace Helpers
+{
+
+template <typename T>
+ImageView<T>::ImageView(vtkImageData* image)
+{
+  this->Data = 0;
+  this->Width = 0;
+  this->NumberOfComponents = image->GetNumberOfScalarComponents();
+  this->NumberOfRows = 0;
+  if(image->GetScalarType() != vtkTypeTraits<T>::VTKTypeID())
+    {
+    std::cerr << "ImageView: the image has scalar type " << image->GetScalarType()
+              << " but the view expects " << vtkTypeTraits<T>::VTKTypeID() << "." << std::endl;
+    return;
+    }
+
+  int* dims = image->GetDimensions();
+  this->Data = static_cast<T*>(image->GetScalarPointer());
+  this->Width = dims[0];
+  this->NumberOfRows = static_cast<vtkIdType>(dims[1]) * dims[2];
+}
+
+template <typename T>
+T* ImageView<T>::GetRow(vtkIdType row) const
+{
+  return this->Data + row * GetRowLength();
+}
+
+template <typename T>
+vtkIdType ImageView<T>::GetNumberOfRows() const
+{
+  return this->NumberOfRows;
+}
+
+template <typename T>
+int ImageView<T>::GetWidth() const
+{
+  return this->Width;
+}
+
+template <typename T>
+int ImageView<T>::GetNumberOfComponents() const
+{
+  return this->NumberOfComponents;
+}
+
+template <typename T>
+vtkIdType ImageView<T>::GetRowLength() const
+{
+  return static_cast<vtkIdType>(this->Width) * this->NumberOfComponents;
+}
+
+// The vtkSMPTools functors. Each one processes the rows [begin, end).
+namespace Internal
+{
+
+template <typename T>
+struct FillFunctor
+{
+  ImageView<T> Image;
+  const T* Pixel;
+
+  FillFunctor(vtkImageData* image, const T* pixel) : Image(image), Pixel(pixel) {}
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const int numberOfComponents = this->Image.GetNumberOfComponents();
+    const int width = this->Image.GetWidth();
+    for(vtkIdType row = begin; row < end; ++row)
+      {
+      T* value = this->Image.GetRow(row);
+      for(int x = 0; x < width; ++x)
+        {
+        for(int component = 0; component < numberOfComponents; ++component)
+          {
+          *value++ = this->Pixel[component];
+          }
+        }
+      }
+  }
+};
+
+template <typename TInput, typename TOutput, typename TFunctor>
+struct MapFunctor
+{
+  ImageView<TInput> Input;
+  ImageView<TOutput> Output;
+  TFunctor Functor;
+
+  MapFunctor(vtkImageData* input, vtkImageData* output, TFunctor functor) : Input(input), Output(output), Functor(functor) {}
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const int inputComponents = this->Input.GetNumberOfComponents();
+    const int outputComponents = this->Output.GetNumberOfComponents();
+    const int width = this->Input.GetWidth();
+    for(vtkIdType row = begin; row < end; ++row)
+      {
+      const TInput* inputPixel = this->Input.GetRow(row);
+      TOutput* outputPixel = this->Output.GetRow(row);
+      for(int x = 0; x < width; ++x)
+        {
+        this->Functor(inputPixel, outputPixel);
+        inputPixel += inputComponents;
+        outputPixel += outputComponents;
+        }
+      }
+  }
+};
+
+template <typename TInputA, typename TInputB, typename TOutput, typename TFunctor>
+struct ZipFunctor
+{
+  ImageView<TInputA> InputA;
+  ImageView<TInputB> InputB;
+  ImageView<TOutput> Output;
+  TFunctor Functor;
+
+  ZipFunctor(vtkImageData* inputA, vtkImageData* inputB, vtkImageData* output, TFunctor functor) :
+    InputA(inputA), InputB(inputB), Output(output), Functor(functor) {}
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const int componentsA = this->InputA.GetNumberOfComponents();
+    const int componentsB = this->InputB.GetNumberOfComponents();
+    const int outputComponents = this->Output.GetNumberOfComponents();
+    const int width = this->InputA.GetWidth();
+    for(vtkIdType row = begin; row < end; ++row)
+      {
+      const TInputA* pixelA = this->InputA.GetRow(row);
+      const TInputB* pixelB = this->InputB.GetRow(row);
+      TOutput* outputPixel = this->Output.GetRow(row);
+      for(int x = 0; x < width; ++x)
+        {
+        this->Functor(pixelA, pixelB, outputPixel);
+        pixelA += componentsA;
+        pixelB += componentsB;
+        outputPixel += outputComponents;
+        }
+      }
+  }
+};
+
+template <typename T>
+bool HasScalarType(vtkImageData* image)
+{
+  return image->GetScalarType() == vtkTypeTraits<T>::VTKTypeID();
+}
+
+inline bool HaveSameDimensions(vtkImageData* imageA, vtkImageData* imageB)
+{
+  int* dimsA = imageA->GetDimensions();
+  int* dimsB = imageB->GetDimensions();
+  return dimsA[0] == dimsB[0] && dimsA[1] == dimsB[1] && dimsA[2] == dimsB[2];
+}
+
+template <typename T>
+void AllocateLike(vtkImageData* input, vtkImageData* output, int numberOfComponents)
+{
+  if(output == input)
+    {
+    return;
+    }
+  output->SetDimensions(input->GetDimensions());
+  output->AllocateScalars(vtkTypeTraits<T>::VTKTypeID(), numberOfComponents);
+}
+
+} // end namespace Internal
+
+template <typename T>
+void ParallelFill(vtkImageData* image, const T* pixel)
+{
+  if(!Internal::HasScalarType<T>(image))
+    {
+    std::cerr << "ParallelFill: the scalar type of the image doesn't match the pixel type." << std::endl;
+    return;
+    }
+
+  Internal::FillFunctor<T> functor(image, pixel);
+  vtkSMPTools::For(0, functor.Image.GetNumberOfRows(), functor);
+}
+
+template <typename TInput, typename TOutput, typename TFunctor>
+void ParallelMap(vtkImageData* input, vtkImageData* output, int numberOfOutputComponents, TFunctor functor)
+{
+  if(!Internal::HasScalarType<TInput>(input))
+    {
+    std::cerr << "ParallelMap: the scalar type of the input doesn't match TInput." << std::endl;
+    return;
+    }
+  if(output == input && !Internal::HasScalarType<TOutput>(output))
+    {
+    std::cerr << "ParallelMap: the input is the output, so TInput and TOutput must be the same type." << std::endl;
+    return;
+    }
+
+  Internal::AllocateLike<TOutput>(input, output, numberOfOutputComponents);
+
+  Internal::MapFunctor<TInput, TOutput, TFunctor> mapFunctor(input, output, functor);
+  vtkSMPTools::For(0, mapFunctor.Input.GetNumberOfRows(), mapFunctor);
+}
+
+template <typename TInputA, typename TInputB, typename TOutput, typename TFunctor>
+void ParallelZip(vtkImageData* inputA, vtkImageData* inputB, vtkImageData* output, int numberOfOutputComponents, TFunctor functor)
+{
+  if(!Internal::HasScalarType<TInputA>(inputA) || !Internal::HasScalarType<TInputB>(inputB))
+    {
+    std::cerr << "ParallelZip: the scalar types of the inputs don't match TInputA and TInputB." << std::endl;
+    return;
+    }
+  if(!Internal::HaveSameDimensions(inputA, inputB))
+    {
+    std::cerr << "ParallelZip: the inputs must have the same dimensions." << std::endl;
+    return;
+    }
+  if((output == inputA || output == inputB) && !Internal::HasScalarType<TOutput>(output))
+    {
+    std::cerr << "ParallelZip: an input is the output, so its type must match TOutput." << std::endl;
+    return;
+    }
+
+  if(output != inputA && output != inputB)
+    {
+    Internal::AllocateLike<TOutput>(inputA, output, numberOfOutputComponents);
+    }
+
+  Internal::ZipFunctor<TInputA, TInputB, TOutput, TFunctor> zipFunctor(inputA, inputB, output, functor);
+  vtkSMPTools::For(0, zipFunctor.InputA.GetNumberOfRows(), zipFunctor);
+}
+
+} // end namespace
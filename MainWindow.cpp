@@ -20,25 +20,37 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // VTK
 #include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCommand.h>
+#include <vtkEventQtSlotConnect.h>
 #include <vtkMath.h>
 #include <vtkPoints.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
 #include <vtkSmartPointer.h>
-#include <vtkTransform.h>
-#include <vtkTransformPolyDataFilter.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkUnsignedCharArray.h>
 #include <vtkVertexGlyphFilter.h>
 
 // STL
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 // Qt
 #include <QButtonGroup>
+#include <QFileDialog>
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(QWidget *parent) : Model(&this->FrameProfiler)
 {
   // Setup the GUI and connect all of the signals and slots
   setupUi(this);
@@ -56,222 +68,48 @@ MainWindow::MainWindow(QWidget *parent)
   radToHSV->setChecked(true);
   
   this->Renderer = vtkSmartPointer<vtkRenderer>::New();
-  this->Colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  
-  this->Colors->SetNumberOfComponents(3);
-  this->Colors->SetName ("Colors");
 
   this->Transition = 0.0f;
   
-  this->Spacing = 10;
   this->MaxNumberOfSteps = 100;
   this->MaxSpeed = 1000;
   this->CurrentStep = 0;
   
-  this->RGBPoints.PolyData->GetPointData()->SetScalars(this->Colors);
-  this->TransitionPoints.PolyData->GetPointData()->SetScalars(this->Colors);
-  this->HSVPoints.PolyData->GetPointData()->SetScalars(this->Colors);
-  this->CIELabPoints.PolyData->GetPointData()->SetScalars(this->Colors);
+  this->TransitionPoints.PolyData->GetPointData()->SetScalars(this->Model.Colors);
 
   this->qvtkWidget->GetRenderWindow()->AddRenderer(this->Renderer);
 
-  CreateColors();
-  SetupRGBCube();
-  SetupHSVCylinder();
-  SetupCIELab();
-
   this->Renderer->AddViewProp(this->TransitionPoints.Actor);
 
+  this->StatisticsText = vtkSmartPointer<vtkTextActor>::New();
+  this->StatisticsText->SetPosition(10, 10);
+  this->StatisticsText->GetTextProperty()->SetFontSize(14);
+  this->StatisticsText->SetVisibility(this->FrameProfiler.GetEnabled());
+  this->Renderer->AddViewProp(this->StatisticsText);
+
+  this->PickTolerance = 5;
+  this->AnimationPickInterval = 100;
+
+  this->SelectionPolyData = vtkSmartPointer<vtkPolyData>::New();
+  this->SelectionPolyData->SetPoints(this->TransitionPoints.Points);
+  this->SelectionPolyData->GetPointData()->SetScalars(this->Model.Colors);
+  this->SelectionMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  this->SelectionMapper->SetInputData(this->SelectionPolyData);
+  this->SelectionActor = vtkSmartPointer<vtkActor>::New();
+  this->SelectionActor->SetMapper(this->SelectionMapper);
+  this->SelectionActor->GetProperty()->SetPointSize(8);
+  this->Renderer->AddViewProp(this->SelectionActor);
+
+  this->Connections = vtkSmartPointer<vtkEventQtSlotConnect>::New();
+  this->Connections->Connect(this->qvtkWidget->GetInteractor(), vtkCommand::MouseMoveEvent,
+                             this, SLOT(slot_MouseMove(vtkObject*, unsigned long, void*, void*)));
+  this->Connections->Connect(this->qvtkWidget->GetInteractor(), vtkCommand::KeyPressEvent,
+                             this, SLOT(slot_KeyPress(vtkObject*, unsigned long, void*, void*)));
+
   connect(&timer, SIGNAL(timeout()), this, SLOT(Step()));
   SetupFromGUI();
 }
 
-void MainWindow::CreateColors()
-{
-  for(unsigned int r = 0; r < 256; r += this->Spacing)
-    {
-    for(unsigned int g = 0; g < 256; g += this->Spacing)
-      {
-      for(unsigned int b = 0; b < 256; b += this->Spacing)
-        {
-        unsigned char color[3] = {r,g,b};
-        this->Colors->InsertNextTupleValue(color);
-        }
-      }
-    }
-}
-
-void MainWindow::SetupRGBCube()
-{
-  std::cout << "SetupRGBCube" << std::endl;
-  this->RGBPoints.Points->Reset();
-  this->RGBPoints.Points->Squeeze();
-  for(unsigned int i = 0 ;i < this->Colors->GetNumberOfTuples(); ++i)
-    {
-    unsigned char color[3];
-    this->Colors->GetTupleValue(i, color);
-    this->RGBPoints.Points->InsertNextPoint(color[0], color[1], color[2]);
-    }
-}
-
-void MainWindow::SetupCIELab()
-{
-  std::cout << "SetupCIELab" << std::endl;
-  this->CIELabPoints.Points->Reset();
-  this->CIELabPoints.Points->Squeeze();
-  for(unsigned int i = 0 ;i < this->Colors->GetNumberOfTuples(); ++i)
-    {
-    unsigned char color[3];
-    this->Colors->GetTupleValue(i, color);
-    
-    float cielab[3];
-    RGBtoCIELab(color, cielab);
-
-    //double color_double[3] = {static_cast<float>(color[0])/255.0f, static_cast<float>(color[1])/255.0f, static_cast<float>(color[2])/255.0f};
-    //double cielab[3];
-    //vtkMath::RGBToLab(color_double, cielab);
-
-    float L = cielab[0];
-    float a = cielab[1];
-    float b = cielab[2];
-
-//     float z = v*0.01f; // The spacing of the Z/V slices of the cylinder are way too far apart without this scaling
-//     float x = r*cos(theta * 2.0f * vtkMath::Pi());
-//     float y = r*sin(theta * 2.0f * vtkMath::Pi());
-    float xyz[3] = {L,a,b};
-    this->CIELabPoints.Points->InsertNextPoint(xyz);
-    }
-
-  bool fitInRGBCube = false;
-  if(fitInRGBCube)
-    {
-    // Translate and scale the points to they are in the same position and magnitude as the RGB cube
-    double cielabBounds[6];
-    this->CIELabPoints.Points->GetBounds(cielabBounds);
-
-    double rgbBounds[6];
-    this->RGBPoints.Points->GetBounds(rgbBounds);
-
-    OutputBounds("rgbBounds", rgbBounds);
-
-    float scale[3];
-    for(unsigned int i = 0 ; i < 3; ++i)
-      {
-      scale[i] = (rgbBounds[2*i + 1] - rgbBounds[2*i])/(cielabBounds[2*i + 1] - cielabBounds[2*i]);
-      }
-    OutputBounds("cielabBounds", cielabBounds);
-
-    std::cout << "Scale: " << scale[0] << " " << scale[1] << " " << scale[2] << std::endl;
-    
-    vtkSmartPointer<vtkTransform> scaleTransform = vtkSmartPointer<vtkTransform>::New();
-    scaleTransform->Scale(scale);
-    
-    vtkSmartPointer<vtkTransformPolyDataFilter> scaleTransformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-    scaleTransformFilter->SetInputData(this->CIELabPoints.PolyData);
-    scaleTransformFilter->SetTransform(scaleTransform);
-    scaleTransformFilter->Update();
-
-    double scaledBounds[6];
-    scaleTransformFilter->GetOutput()->GetBounds(scaledBounds);
-
-    OutputBounds("scaledBounds", scaledBounds);
-    
-    float translation[3];
-    for(unsigned int i = 0 ; i < 3; ++i)
-      {
-      translation[i] = rgbBounds[2*i] - scaledBounds[2*i];
-      }
-      
-    vtkSmartPointer<vtkTransform> translateTransform = vtkSmartPointer<vtkTransform>::New();
-    translateTransform->Translate(translation);
-
-    vtkSmartPointer<vtkTransformPolyDataFilter> translateTransformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-    translateTransformFilter->SetInputConnection(scaleTransformFilter->GetOutputPort());
-    translateTransformFilter->SetTransform(translateTransform);
-    translateTransformFilter->Update();
-    
-    std::cout << "translation: " << translation[0] << " " << translation[1] << " " << translation[2] << std::endl;
-
-    this->CIELabPoints.Points->DeepCopy(translateTransformFilter->GetOutput()->GetPoints());
-
-    double newBounds[6];
-    this->CIELabPoints.Points->GetBounds(newBounds);
-    OutputBounds("newBounds", newBounds);
-
-    this->CIELabPoints.Points->Modified();
-    this->CIELabPoints.PolyData->Modified();
-    //transformFilter->RemoveAllInputs();
-    }
-}
-
-void MainWindow::SetupHSVCylinder()
-{
-  std::cout << "SetupHSVCylinder" << std::endl;
-  this->HSVPoints.Points->Reset();
-  this->HSVPoints.Points->Squeeze();
-  for(unsigned int i = 0 ;i < this->Colors->GetNumberOfTuples(); ++i)
-    {
-    unsigned char color[3];
-    this->Colors->GetTupleValue(i, color);
-    float floatRGB[3] = {color[0], color[1], color[2]};
-
-    float hsv[3];
-    vtkMath::RGBToHSV(floatRGB, hsv);
-
-    float h = hsv[0];
-    float s = hsv[1];
-    float v = hsv[2];
-
-    float r = s; // Radius of cylinder
-    float theta = h; // Angle
-
-    float z = v*0.01f; // The spacing of the Z/V slices of the cylinder are way too far apart without this scaling
-    float x = r*cos(theta * 2.0f * vtkMath::Pi());
-    float y = r*sin(theta * 2.0f * vtkMath::Pi());
-    float xyz[3] = {x,y,z};
-    this->HSVPoints.Points->InsertNextPoint(xyz);
-    }
-
-  // Translate and scale the points to they are in the same position and magnitude as the RGB cube
-  double hsvBounds[6];
-  this->HSVPoints.Points->GetBounds(hsvBounds);
-
-  double rgbBounds[6];
-  this->RGBPoints.Points->GetBounds(rgbBounds);
-
-  float translation[3];
-  float scale[3];
-  for(unsigned int i = 0 ; i < 3; ++i)
-    {
-    //scale[i] = (rgbBounds[2*i] - rgbBounds[2*i + 1])/(hsvBounds[2*i] - hsvBounds[2*i + 1]);
-    scale[i] = (rgbBounds[2*i + 1] - rgbBounds[2*i])/(hsvBounds[2*i + 1] - hsvBounds[2*i]);
-    translation[i] = rgbBounds[2*i] - hsvBounds[2*i];
-    }
-//   std::cout  << "xmin: " << bounds[0] << " "
-//              << "xmax: " << bounds[1] << std::endl
-//              << "ymin: " << bounds[2] << " "
-//              << "ymax: " << bounds[3] << std::endl
-//              << "zmin: " << bounds[4] << " "
-//              << "zmax: " << bounds[5] << std::endl;
-
-  std::cout << "Scale: " << scale[0] << " " << scale[1] << " " << scale[2] << std::endl;
-  std::cout << "translation: " << translation[0] << " " << translation[1] << " " << translation[2] << std::endl;
-  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
-  transform->Scale(scale);
-  transform->Translate(translation);
-
-  vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  transformFilter->SetInputData(this->HSVPoints.PolyData);
-  transformFilter->SetTransform(transform);
-  transformFilter->Update();
-
-  this->HSVPoints.Points->DeepCopy(transformFilter->GetOutput()->GetPoints());
-  
-  this->HSVPoints.Points->Modified();
-  this->HSVPoints.PolyData->Modified();
-  transformFilter->RemoveAllInputs();
-}
-
 void MainWindow::on_btnTransition_clicked()
 {
   if(this->CurrentPoints == this->NextPoints)
@@ -279,7 +117,6 @@ void MainWindow::on_btnTransition_clicked()
     return;
     }
   int value = this->MaxSpeed - static_cast<float>(this->sldSpeed->value())/100.f * static_cast<float>(this->MaxSpeed);
-  std::cout << "Speed value: " << value << std::endl;
   this->timer.start(value);
 }
 
@@ -300,111 +137,171 @@ void MainWindow::on_btnStep_clicked()
 void MainWindow::Step()
 {
   this->CurrentStep++;
-  std::cout << "Current step: " << this->CurrentStep << std::endl;
-  
+
   this->Transition = static_cast<float>(this->CurrentStep)/static_cast<float>(static_cast<float>(this->sldSteps->value())/100. * this->MaxNumberOfSteps);
-  std::cout << "Transition: " << this->Transition << std::endl;
   if(this->Transition > 1.0f)
     {
     this->timer.stop();
     this->CurrentStep = 0;
     return;
     }
-  for(unsigned int pointId = 0; pointId < this->CurrentPoints->GetNumberOfPoints(); ++pointId)
-    {
-    double newPoint[3];
-    double current[3];
-    this->CurrentPoints->GetPoint(pointId, current);
-    //std::cout << "rgb: " << rgb[0] << " " << rgb[1] << " " << rgb[2] << std::endl;
-    double next[3];
-    this->NextPoints->GetPoint(pointId, next);
-    //std::cout << "hsv: " << hsv[0] << " " << hsv[1] << " " << hsv[2] << std::endl;
-    for(unsigned int component = 0; component < 3; component++)
-      {
-      newPoint[component] = current[component] + (next[component] - current[component]) * this->Transition;
-      }
-    //std::cout << "newPoint: " << newPoint[0] << " " << newPoint[1] << " " << newPoint[2] << std::endl;
-    this->TransitionPoints.Points->SetPoint(pointId, newPoint);
 
-    //double verify[3];
-    //this->CurrentPoints.Points->GetPoint(pointId, verify);
-    //std::cout << "verify: " << verify[0] << " " << verify[1] << " " << verify[2] << std::endl;
-    }
+  this->FrameProfiler.BeginFrame();
+
+  {
+  PROFILE_SCOPE(&this->FrameProfiler, "Interpolate");
+  ColorSpaceModel::Interpolate(this->CurrentPoints, this->NextPoints, this->Transition, this->TransitionPoints.Points);
+  }
 
-  //std::cout << "Number of current points: " << this->CurrentPoints.Points->GetNumberOfPoints() << std::endl;
-    
+  {
+  // Time the pipeline update separately from the drawing itself
+  PROFILE_SCOPE(&this->FrameProfiler, "Modified");
   this->TransitionPoints.Points->Modified();
-  //this->PolyData->Modified();
-  //this->VertexGlyphFilter->Update();
+  this->TransitionPoints.VertexGlyphFilter->Update();
+  }
+
+  UpdateStatisticsText();
+
+  {
+  PROFILE_SCOPE(&this->FrameProfiler, "Render");
   this->qvtkWidget->GetRenderWindow()->Render();
+  }
+
+  this->FrameProfiler.EndFrame();
+}
+
+void MainWindow::UpdateStatisticsText()
+{
+  if(!this->FrameProfiler.GetEnabled())
+    {
+    return;
+    }
+
+  std::stringstream ss;
+  ss.precision(3);
+  ss << this->FrameProfiler.GetFramesPerSecond() << " fps, "
+     << this->FrameProfiler.GetFrameTime() << " ms/frame" << std::endl
+     << "interpolate " << this->FrameProfiler.GetLastDuration("Interpolate") << " ms, "
+     << "modified " << this->FrameProfiler.GetLastDuration("Modified") << " ms, "
+     << "render " << this->FrameProfiler.GetLastDuration("Render") << " ms";
+  this->StatisticsText->SetInput(ss.str().c_str());
 }
 
 void MainWindow::SetupFromGUI()
 {
   if(radFromRGB->isChecked())
     {
-    this->CurrentPoints = this->RGBPoints.Points;
-    this->TransitionPoints.Points->DeepCopy(this->RGBPoints.Points);
+    this->CurrentPoints = this->Model.RGBPoints.Points;
+    this->TransitionPoints.Points->DeepCopy(this->Model.RGBPoints.Points);
     }
   else if(radFromHSV->isChecked())
     {
-    this->CurrentPoints = this->HSVPoints.Points;
-    this->TransitionPoints.Points->DeepCopy(this->HSVPoints.Points);
+    this->CurrentPoints = this->Model.HSVPoints.Points;
+    this->TransitionPoints.Points->DeepCopy(this->Model.HSVPoints.Points);
     }
   else if(radFromCIELab->isChecked())
     {
-    this->CurrentPoints = this->CIELabPoints.Points;
-    this->TransitionPoints.Points->DeepCopy(this->CIELabPoints.Points);
+    this->CurrentPoints = this->Model.CIELabPoints.Points;
+    this->TransitionPoints.Points->DeepCopy(this->Model.CIELabPoints.Points);
     }
 
   if(radToRGB->isChecked())
     {
-    this->NextPoints = this->RGBPoints.Points;
+    this->NextPoints = this->Model.RGBPoints.Points;
     }
   else if(radToHSV->isChecked())
     {
-    this->NextPoints = this->HSVPoints.Points;
+    this->NextPoints = this->Model.HSVPoints.Points;
     }
   else if(radToCIELab->isChecked())
     {
-    this->NextPoints = this->CIELabPoints.Points;
+    this->NextPoints = this->Model.CIELabPoints.Points;
+    }
+
+  UpdateTransitionColors();
+}
+
+void MainWindow::UpdateTransitionColors()
+{
+  // A transition to or from CIELab shows the gamut mapped colors so out-of-gamut edits stand out
+  vtkUnsignedCharArray* colors = this->Model.Colors;
+  if(this->CurrentPoints == this->Model.CIELabPoints.Points || this->NextPoints == this->Model.CIELabPoints.Points)
+    {
+    colors = this->Model.CIELabColors;
     }
+  this->TransitionPoints.PolyData->GetPointData()->SetScalars(colors);
+  this->SelectionPolyData->GetPointData()->SetScalars(colors);
+}
+
+void MainWindow::UpdateCIELab()
+{
+  GamutMappingEnum modes[3] = {GAMUT_CLIP, GAMUT_CHROMA_REDUCTION, GAMUT_COMPRESSION};
+  int mode = std::max(0, std::min(2, this->cmbGamutMapping->currentIndex()));
+  float chromaScale = this->sldChroma->value() / 100.0f;
+
+  unsigned int numberOfOutOfGamut = this->Model.EditCIELab(chromaScale, modes[mode]);
+  this->statusBar()->showMessage(QString("%1 colors out of gamut").arg(numberOfOutOfGamut));
+
+  if(this->CurrentPoints == this->Model.CIELabPoints.Points)
+    {
+    this->TransitionPoints.Points->DeepCopy(this->Model.CIELabPoints.Points);
+    }
+  this->qvtkWidget->GetRenderWindow()->Render();
+}
+
+void MainWindow::on_sldChroma_valueChanged(int)
+{
+  UpdateCIELab();
+}
+
+void MainWindow::on_cmbGamutMapping_currentIndexChanged(int)
+{
+  UpdateCIELab();
 }
 
 void MainWindow::on_radFromRGB_clicked()
 {
-  this->CurrentPoints = this->RGBPoints.Points;
-  this->TransitionPoints.Points->DeepCopy(this->RGBPoints.Points);
+  this->CurrentPoints = this->Model.RGBPoints.Points;
+  this->TransitionPoints.Points->DeepCopy(this->Model.RGBPoints.Points);
+  UpdateTransitionColors();
   this->qvtkWidget->GetRenderWindow()->Render();
 }
 
 void MainWindow::on_radFromHSV_clicked()
 {
-  this->CurrentPoints = this->HSVPoints.Points;
-  this->TransitionPoints.Points->DeepCopy(this->HSVPoints.Points);
+  this->CurrentPoints = this->Model.HSVPoints.Points;
+  this->TransitionPoints.Points->DeepCopy(this->Model.HSVPoints.Points);
+  UpdateTransitionColors();
   this->qvtkWidget->GetRenderWindow()->Render();
 }
 
 void MainWindow::on_radFromCIELab_clicked()
 {
-  this->CurrentPoints = this->CIELabPoints.Points;
-  this->TransitionPoints.Points->DeepCopy(this->CIELabPoints.Points);
+  this->CurrentPoints = this->Model.CIELabPoints.Points;
+  this->TransitionPoints.Points->DeepCopy(this->Model.CIELabPoints.Points);
+  UpdateTransitionColors();
   this->qvtkWidget->GetRenderWindow()->Render();
 }
 
 void MainWindow::on_radToRGB_clicked()
 {
-  this->NextPoints = this->RGBPoints.Points;
+  this->NextPoints = this->Model.RGBPoints.Points;
+  UpdateTransitionColors();
+  this->qvtkWidget->GetRenderWindow()->Render();
 }
 
 void MainWindow::on_radToHSV_clicked()
 {
-  this->NextPoints = this->HSVPoints.Points;
+  this->NextPoints = this->Model.HSVPoints.Points;
+  UpdateTransitionColors();
+  this->qvtkWidget->GetRenderWindow()->Render();
 }
 
 void MainWindow::on_radToCIELab_clicked()
 {
-  this->NextPoints = this->CIELabPoints.Points;
+  this->NextPoints = this->Model.CIELabPoints.Points;
+  UpdateTransitionColors();
+  this->qvtkWidget->GetRenderWindow()->Render();
 }
 
 void MainWindow::on_sldSpeed_valueChanged(int value)
@@ -417,12 +314,157 @@ void MainWindow::on_sldSteps_valueChanged(int value)
 
 }
 
-void OutputBounds(const std::string& name, double bounds[6])
+void MainWindow::on_actionSaveTrace_triggered()
 {
-  std::cout << name << " xmin: " << bounds[0] << " "
-            << name << " xmax: " << bounds[1] << std::endl
-            << name << " ymin: " << bounds[2] << " "
-            << name << " ymax: " << bounds[3] << std::endl
-            << name << " zmin: " << bounds[4] << " "
-            << name << " zmax: " << bounds[5] << std::endl;
-}
\ No newline at end of file
+  QString fileName = QFileDialog::getSaveFileName(this, "Save Trace", "trace.json", "Chrome trace (*.json)");
+  if(fileName.isEmpty())
+    {
+    return;
+    }
+
+  if(!this->FrameProfiler.WriteChromeTrace(fileName.toStdString()))
+    {
+    std::cerr << "Could not write " << fileName.toStdString() << std::endl;
+    }
+}
+
+vtkIdType MainWindow::PickPoint(int x, int y)
+{
+  // The ray through the pixel, from the near to the far clipping plane
+  double ray[2][3];
+  for(unsigned int end = 0; end < 2; ++end)
+    {
+    this->Renderer->SetDisplayPoint(x, y, end);
+    this->Renderer->DisplayToWorld();
+    double worldPoint[4];
+    this->Renderer->GetWorldPoint(worldPoint);
+    for(unsigned int i = 0; i < 3; ++i)
+      {
+      ray[end][i] = worldPoint[i] / worldPoint[3];
+      }
+    }
+
+  // Convert the tolerance from pixels to world units at the focal point
+  vtkCamera* camera = this->Renderer->GetActiveCamera();
+  int* size = this->Renderer->GetSize();
+  double viewHeight = 0.0;
+  if(camera->GetParallelProjection())
+    {
+    viewHeight = 2.0 * camera->GetParallelScale();
+    }
+  else
+    {
+    viewHeight = 2.0 * camera->GetDistance() * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle() / 2.0));
+    }
+  double tolerance = this->PickTolerance * viewHeight / std::max(size[1], 1);
+
+  return this->TransitionPoints.Locator.FindClosestPointToRay(ray[0], ray[1], tolerance);
+}
+
+void MainWindow::ShowPointInfo(vtkIdType pointId)
+{
+  if(pointId < 0)
+    {
+    return;
+    }
+
+  unsigned char color[3];
+  this->Model.Colors->GetTupleValue(pointId, color);
+
+  float rgb[3] = {color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f};
+  float hsv[3];
+  RGBtoHSV(rgb, hsv);
+
+  // The CIELab points are the Lab values themselves
+  double cielab[3];
+  this->Model.CIELabPoints.Points->GetPoint(pointId, cielab);
+
+  std::stringstream ss;
+  ss.precision(3);
+  ss << "RGB: " << static_cast<int>(color[0]) << " " << static_cast<int>(color[1]) << " " << static_cast<int>(color[2]) << std::endl
+     << "HSV: " << hsv[0] * 360.0f << " " << hsv[1] << " " << hsv[2] << std::endl
+     << "CIELab: " << cielab[0] << " " << cielab[1] << " " << cielab[2] << std::endl
+     << "Neighbors:";
+
+  double position[3];
+  this->TransitionPoints.Points->GetPoint(pointId, position);
+  std::vector<vtkIdType> neighbors;
+  this->TransitionPoints.Locator.FindClosestNPoints(6, position, neighbors);
+  for(unsigned int i = 0; i < neighbors.size(); ++i)
+    {
+    if(neighbors[i] == pointId)
+      {
+      continue;
+      }
+    unsigned char neighborColor[3];
+    this->Model.Colors->GetTupleValue(neighbors[i], neighborColor);
+    ss << std::endl << "  " << static_cast<int>(neighborColor[0]) << " "
+       << static_cast<int>(neighborColor[1]) << " " << static_cast<int>(neighborColor[2]);
+    }
+
+  this->lblPointInfo->setText(ss.str().c_str());
+}
+
+void MainWindow::BrushSelect(vtkIdType pointId)
+{
+  if(pointId < 0)
+    {
+    return;
+    }
+
+  double radius = this->spnBrushRadius->value() / 100.0 * this->TransitionPoints.Locator.GetDiagonalLength();
+  double position[3];
+  this->TransitionPoints.Points->GetPoint(pointId, position);
+
+  std::vector<vtkIdType> selected;
+  this->TransitionPoints.Locator.FindPointsWithinRadius(radius, position, selected);
+
+  vtkSmartPointer<vtkCellArray> vertices = vtkSmartPointer<vtkCellArray>::New();
+  for(unsigned int i = 0; i < selected.size(); ++i)
+    {
+    vertices->InsertNextCell(1, &selected[i]);
+    }
+  this->SelectionPolyData->SetVerts(vertices);
+  this->SelectionPolyData->Modified();
+
+  this->statusBar()->showMessage(QString("Selected %1 colors").arg(selected.size()));
+  this->qvtkWidget->GetRenderWindow()->Render();
+}
+
+void MainWindow::slot_MouseMove(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+  vtkRenderWindowInteractor* interactor = vtkRenderWindowInteractor::SafeDownCast(caller);
+  int* position = interactor->GetEventPosition();
+
+  if(this->timer.isActive() && this->LastPick.isValid() && this->LastPick.elapsed() < this->AnimationPickInterval)
+    {
+    return;
+    }
+  this->LastPick.start();
+
+  vtkIdType pointId;
+  {
+  PROFILE_SCOPE(&this->FrameProfiler, "Pick");
+  pointId = PickPoint(position[0], position[1]);
+  }
+  ShowPointInfo(pointId);
+}
+
+void MainWindow::slot_KeyPress(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+  vtkRenderWindowInteractor* interactor = vtkRenderWindowInteractor::SafeDownCast(caller);
+  if(interactor->GetKeyCode() != 'b')
+    {
+    return;
+    }
+  int* position = interactor->GetEventPosition();
+  BrushSelect(PickPoint(position[0], position[1]));
+}
+
+void MainWindow::on_btnClearSelection_clicked()
+{
+  this->SelectionPolyData->SetVerts(vtkSmartPointer<vtkCellArray>::New());
+  this->SelectionPolyData->Modified();
+  this->statusBar()->clearMessage();
+  this->qvtkWidget->GetRenderWindow()->Render();
+}
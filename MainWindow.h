@@ -19,22 +19,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MAINWINDOW_H
 
 // Custom
+#include "ColorSpaceModel.h"
 #include "DisplayPoints.h"
+#include "Profiler.h"
 
 // Qt
 #include "ui_MainWindow.h"
+#include <QElapsedTimer>
 #include <QTimer>
 
 // VTK
 #include <vtkSmartPointer.h>
+#include <vtkType.h>
 
 // Forward declarations
 class vtkPolyDataMapper;
 class vtkActor;
+class vtkEventQtSlotConnect;
+class vtkObject;
 class vtkRenderer;
 class vtkVertexGlyphFilter;
 class vtkPoints;
 class vtkPolyData;
+class vtkTextActor;
 class vtkUnsignedCharArray;
 
 class MainWindow : public QMainWindow, private Ui::MainWindow
@@ -58,29 +65,65 @@ public slots:
 
   void on_sldSpeed_valueChanged(int);
   void on_sldSteps_valueChanged(int);
+
+  void on_actionSaveTrace_triggered();
+
+  void on_btnClearSelection_clicked();
+
+  void on_sldChroma_valueChanged(int);
+  void on_cmbGamutMapping_currentIndexChanged(int);
+
+  void slot_MouseMove(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+  void slot_KeyPress(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
 protected:
 
   QTimer timer;
   
-  void CreateColors();
-
   void SetupFromGUI();
+
+  /** Color the transition points by the gamut mapped CIELab colors when either end is CIELab. */
+  void UpdateTransitionColors();
+
+  /** Apply the chroma edit and gamut mapping chosen in the GUI to the CIELab points. */
+  void UpdateCIELab();
+
+  void UpdateStatisticsText();
+
+  /** The id of the displayed point under the given display position, or -1. */
+  vtkIdType PickPoint(int x, int y);
+
+  void ShowPointInfo(vtkIdType pointId);
+
+  /** Select every point within the brush radius of 'pointId' in the displayed space. */
+  void BrushSelect(vtkIdType pointId);
   
-  void SetupRGBCube();
-  void SetupHSVCylinder();
-  void SetupCIELab();
-  
+  // The profiler must be declared before the model, which records its setup into it
+  Profiler FrameProfiler;
+  vtkSmartPointer<vtkTextActor> StatisticsText; // FPS/latency overlay
+
+  ColorSpaceModel Model;
+
   vtkPoints* CurrentPoints;
   vtkPoints* NextPoints;
   DisplayPoints TransitionPoints;
-  DisplayPoints RGBPoints;
-  DisplayPoints HSVPoints;
-  DisplayPoints CIELabPoints;
 
-  vtkSmartPointer<vtkUnsignedCharArray> Colors;
   vtkSmartPointer<vtkRenderer> Renderer;
 
-  unsigned int Spacing;
+  vtkSmartPointer<vtkEventQtSlotConnect> Connections;
+
+  // The selected points are drawn larger. This shares the transition points, so the
+  // selection stays on the same colors in every space and during transitions.
+  vtkSmartPointer<vtkPolyData> SelectionPolyData;
+  vtkSmartPointer<vtkPolyDataMapper> SelectionMapper;
+  vtkSmartPointer<vtkActor> SelectionActor;
+
+  unsigned int PickTolerance; // Pixels
+
+  // Every animation step moves the points, so the next pick updates the locator, which
+  // with millions of points that change bins still costs a counting sort of all of them.
+  // While animating, hover picks are limited to one per AnimationPickInterval.
+  QElapsedTimer LastPick;
+  int AnimationPickInterval; // Milliseconds
 
   float Transition; // This is the 'time' variable in the simulation
   unsigned int MaxNumberOfSteps;
@@ -89,6 +132,4 @@ protected:
 
 };
 
-void OutputBounds(const std::string& name, double bounds[6]);
-
 #endif
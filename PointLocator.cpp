@@ -0,0 +1,601 @@
+/*
+Copyright (C) 2010 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PointLocator.h"
+
+// VTK
+#include <vtkFloatArray.h>
+#include <vtkPoints.h>
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+
+// The number of points per bin the grid aims for
+const double PointsPerBin = 4.0;
+
+// How far the grid extends past the points on each side, as a fraction of their extent
+const double GridMargin = 0.1;
+
+// An update that moves more than one in this many points re-sorts them instead
+const vtkIdType MovedPointsPerSort = 8;
+
+double Distance2(const float* a, const double b[3])
+{
+  double dx = a[0] - b[0];
+  double dy = a[1] - b[1];
+  double dz = a[2] - b[2];
+  return dx*dx + dy*dy + dz*dz;
+}
+
+} // end anonymous namespace
+
+PointLocator::PointLocator()
+{
+  this->Points = 0;
+  this->PointCoordinates = 0;
+  this->BuildTime = 0;
+  this->QueryStamp = 0;
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    this->Bounds[2*i] = 0.0;
+    this->Bounds[2*i + 1] = 0.0;
+    this->GridBounds[2*i] = 0.0;
+    this->GridBounds[2*i + 1] = 0.0;
+    this->Divisions[i] = 1;
+    this->BinSize[i] = 1.0;
+    this->InverseBinSize[i] = 1.0;
+    }
+}
+
+void PointLocator::SetPoints(vtkPoints* points)
+{
+  this->Points = points;
+  this->BuildTime = 0;
+}
+
+void PointLocator::Update()
+{
+  if(!this->Points)
+    {
+    return;
+    }
+  if(this->BuildTime != 0 && this->Points->GetMTime() == this->BuildTime)
+    {
+    return;
+    }
+
+  UpdateCoordinates();
+  if(this->BuildTime == 0 || !UpdateBins())
+    {
+    Build();
+    }
+  this->BuildTime = this->Points->GetMTime();
+}
+
+void PointLocator::UpdateCoordinates()
+{
+  // Float points (the usual case) are read in place, anything else is copied to floats first
+  vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+  if(this->Points->GetDataType() == VTK_FLOAT)
+    {
+    this->PointCoordinates = static_cast<vtkFloatArray*>(this->Points->GetData())->GetPointer(0);
+    return;
+    }
+
+  this->Coordinates.resize(3 * numberOfPoints);
+  for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    double p[3];
+    this->Points->GetPoint(pointId, p);
+    for(unsigned int i = 0; i < 3; ++i)
+      {
+      this->Coordinates[3*pointId + i] = p[i];
+      }
+    }
+  this->PointCoordinates = numberOfPoints > 0 ? &this->Coordinates[0] : 0;
+}
+
+void PointLocator::ComputeBounds(double bounds[6]) const
+{
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    bounds[2*i] = VTK_DOUBLE_MAX;
+    bounds[2*i + 1] = -VTK_DOUBLE_MAX;
+    }
+  vtkIdType numberOfPoints = static_cast<vtkIdType>(this->PointBins.size());
+  for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    for(unsigned int i = 0; i < 3; ++i)
+      {
+      double value = this->PointCoordinates[3*pointId + i];
+      bounds[2*i] = std::min(bounds[2*i], value);
+      bounds[2*i + 1] = std::max(bounds[2*i + 1], value);
+      }
+    }
+  if(numberOfPoints == 0)
+    {
+    std::fill(bounds, bounds + 6, 0.0);
+    }
+}
+
+void PointLocator::Build()
+{
+  vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+  this->PointBins.resize(numberOfPoints);
+  ComputeBounds(this->Bounds);
+
+  // The grid extends past the points, so they can move a little before they leave it
+  double extent[3];
+  double volume = 1.0;
+  unsigned int nonFlatDimensions = 0;
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    double margin = GridMargin * (this->Bounds[2*i + 1] - this->Bounds[2*i]);
+    this->GridBounds[2*i] = this->Bounds[2*i] - margin;
+    this->GridBounds[2*i + 1] = this->Bounds[2*i + 1] + margin;
+    extent[i] = this->GridBounds[2*i + 1] - this->GridBounds[2*i];
+    if(extent[i] > 0.0)
+      {
+      volume *= extent[i];
+      nonFlatDimensions++;
+      }
+    }
+
+  // Choose the divisions so the bins are roughly cubes holding PointsPerBin points each
+  double numberOfBins = std::max(1.0, static_cast<double>(numberOfPoints) / PointsPerBin);
+  double binLength = 0.0;
+  if(nonFlatDimensions > 0)
+    {
+    binLength = std::pow(volume / numberOfBins, 1.0 / nonFlatDimensions);
+    }
+
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    if(extent[i] > 0.0 && binLength > 0.0)
+      {
+      this->Divisions[i] = std::max(1, std::min(1024, static_cast<int>(extent[i] / binLength)));
+      this->BinSize[i] = extent[i] / this->Divisions[i];
+      this->InverseBinSize[i] = this->Divisions[i] / extent[i];
+      }
+    else
+      {
+      this->Divisions[i] = 1;
+      this->BinSize[i] = 1.0;
+      this->InverseBinSize[i] = 0.0;
+      }
+    }
+
+  vtkIdType totalBins = static_cast<vtkIdType>(this->Divisions[0]) * this->Divisions[1] * this->Divisions[2];
+
+  this->BinCounts.resize(totalBins);
+  for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    this->PointBins[pointId] = GetBinId(&this->PointCoordinates[3*pointId]);
+    }
+
+  SortBins();
+
+  this->BinVisited.assign(totalBins, 0);
+  this->QueryStamp = 0;
+}
+
+bool PointLocator::UpdateBins()
+{
+  vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+  if(numberOfPoints == 0 || numberOfPoints != static_cast<vtkIdType>(this->PointBins.size()))
+    {
+    return false;
+    }
+
+  // Find the points that changed bins, and the bounds in the same pass
+  float lower[3] = {VTK_FLOAT_MAX, VTK_FLOAT_MAX, VTK_FLOAT_MAX};
+  float upper[3] = {-VTK_FLOAT_MAX, -VTK_FLOAT_MAX, -VTK_FLOAT_MAX};
+  this->MovedIds.clear();
+  this->MovedFrom.clear();
+  for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    const float* p = &this->PointCoordinates[3*pointId];
+    for(unsigned int i = 0; i < 3; ++i)
+      {
+      lower[i] = std::min(lower[i], p[i]);
+      upper[i] = std::max(upper[i], p[i]);
+      }
+
+    vtkIdType bin = GetBinId(p);
+    if(bin != this->PointBins[pointId])
+      {
+      this->MovedIds.push_back(pointId);
+      this->MovedFrom.push_back(this->PointBins[pointId]);
+      this->PointBins[pointId] = bin;
+      }
+    }
+
+  // A point that left the grid was put in a bin at the edge; start over
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    if(lower[i] < this->GridBounds[2*i] || upper[i] > this->GridBounds[2*i + 1])
+      {
+      return false;
+      }
+    this->Bounds[2*i] = lower[i];
+    this->Bounds[2*i + 1] = upper[i];
+    }
+
+  // Moving a point costs a few cache misses, sorting costs about one per point
+  if(this->MovedIds.size() > static_cast<std::size_t>(numberOfPoints / MovedPointsPerSort))
+    {
+    SortBins();
+    return true;
+    }
+
+  // Take the moved points out of their old bins, by swapping with the last point of the bin,
+  // before putting them in the spare room of the new ones. Removing them all first lets a
+  // bin take in as many points as just left it.
+  for(std::size_t i = 0; i < this->MovedIds.size(); ++i)
+    {
+    vtkIdType bin = this->MovedFrom[i];
+    vtkIdType last = this->BinOffsets[bin] + --this->BinCounts[bin];
+    vtkIdType position = this->PointPositions[this->MovedIds[i]];
+    this->SortedIds[position] = this->SortedIds[last];
+    this->PointPositions[this->SortedIds[position]] = position;
+    }
+
+  for(std::size_t i = 0; i < this->MovedIds.size(); ++i)
+    {
+    vtkIdType pointId = this->MovedIds[i];
+    vtkIdType bin = this->PointBins[pointId];
+    if(this->BinOffsets[bin] + this->BinCounts[bin] == this->BinOffsets[bin + 1])
+      {
+      // Out of room: lay the bins out again for their new counts
+      SortBins();
+      return true;
+      }
+    vtkIdType position = this->BinOffsets[bin] + this->BinCounts[bin]++;
+    this->SortedIds[position] = pointId;
+    this->PointPositions[pointId] = position;
+    }
+
+  return true;
+}
+
+void PointLocator::SortBins()
+{
+  // Counting sort of the points into the bins
+  vtkIdType totalBins = static_cast<vtkIdType>(this->BinCounts.size());
+  vtkIdType numberOfPoints = static_cast<vtkIdType>(this->PointBins.size());
+  std::fill(this->BinCounts.begin(), this->BinCounts.end(), 0);
+  for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    this->BinCounts[this->PointBins[pointId]]++;
+    }
+
+  // Every bin gets spare room, so points moving between bins can usually be inserted in place
+  this->BinOffsets.resize(totalBins + 1);
+  this->BinOffsets[0] = 0;
+  for(vtkIdType bin = 0; bin < totalBins; ++bin)
+    {
+    vtkIdType count = this->BinCounts[bin];
+    this->BinOffsets[bin + 1] = this->BinOffsets[bin] + count + count / 2 + 2;
+    this->BinCounts[bin] = 0;
+    }
+
+  this->SortedIds.resize(this->BinOffsets[totalBins]);
+  this->PointPositions.resize(numberOfPoints);
+  for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    vtkIdType bin = this->PointBins[pointId];
+    vtkIdType position = this->BinOffsets[bin] + this->BinCounts[bin]++;
+    this->SortedIds[position] = pointId;
+    this->PointPositions[pointId] = position;
+    }
+}
+
+
+void PointLocator::GetBinIndex(const double x[3], int index[3]) const
+{
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    int value = static_cast<int>(std::floor((x[i] - this->GridBounds[2*i]) / this->BinSize[i]));
+    index[i] = std::max(0, std::min(this->Divisions[i] - 1, value));
+    }
+}
+
+vtkIdType PointLocator::GetBinId(const float p[3]) const
+{
+  // The points are inside the grid, so truncating is flooring and only the upper
+  // edge has to be clamped. This runs for every point on every update.
+  int index[3];
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    int value = static_cast<int>((p[i] - this->GridBounds[2*i]) * this->InverseBinSize[i]);
+    index[i] = std::max(0, std::min(value, this->Divisions[i] - 1));
+    }
+  return GetBinId(index[0], index[1], index[2]);
+}
+
+vtkIdType PointLocator::GetBinId(int i, int j, int k) const
+{
+  return i + this->Divisions[0] * (static_cast<vtkIdType>(j) + static_cast<vtkIdType>(this->Divisions[1]) * k);
+}
+
+vtkIdType PointLocator::FindClosestPoint(const double x[3])
+{
+  std::vector<vtkIdType> ids;
+  FindClosestNPoints(1, x, ids);
+  if(ids.empty())
+    {
+    return -1;
+    }
+  return ids[0];
+}
+
+void PointLocator::FindClosestNPoints(unsigned int n, const double x[3], std::vector<vtkIdType>& ids)
+{
+  ids.clear();
+  Update();
+  if(n == 0 || this->PointBins.empty())
+    {
+    return;
+    }
+
+  int home[3];
+  GetBinIndex(x, home);
+
+  double minBinSize = std::min(this->BinSize[0], std::min(this->BinSize[1], this->BinSize[2]));
+  int maxRing = std::max(this->Divisions[0], std::max(this->Divisions[1], this->Divisions[2]));
+
+  // The best candidates so far as (squared distance, id), sorted
+  std::vector<std::pair<double, vtkIdType> > best;
+
+  // Search shells of bins around the home bin. Any bin outside ring r is at least
+  // r * minBinSize away from x, so we can stop once the n-th best is closer than that.
+  for(int ring = 0; ring <= maxRing; ++ring)
+    {
+    for(int k = home[2] - ring; k <= home[2] + ring; ++k)
+      {
+      if(k < 0 || k >= this->Divisions[2])
+        {
+        continue;
+        }
+      for(int j = home[1] - ring; j <= home[1] + ring; ++j)
+        {
+        if(j < 0 || j >= this->Divisions[1])
+          {
+          continue;
+          }
+        bool onShellJK = (std::abs(k - home[2]) == ring || std::abs(j - home[1]) == ring);
+        // Inside the shell only the two end bins along i belong to this ring
+        int step = onShellJK ? 1 : std::max(1, 2 * ring);
+        for(int i = home[0] - ring; i <= home[0] + ring; i += step)
+          {
+          if(i < 0 || i >= this->Divisions[0])
+            {
+            continue;
+            }
+          vtkIdType bin = GetBinId(i, j, k);
+          for(vtkIdType position = this->BinOffsets[bin]; position < this->BinOffsets[bin] + this->BinCounts[bin]; ++position)
+            {
+            double distance2 = Distance2(&this->PointCoordinates[3*this->SortedIds[position]], x);
+            if(best.size() < n || distance2 < best.back().first)
+              {
+              std::pair<double, vtkIdType> candidate(distance2, this->SortedIds[position]);
+              best.insert(std::upper_bound(best.begin(), best.end(), candidate), candidate);
+              if(best.size() > n)
+                {
+                best.pop_back();
+                }
+              }
+            }
+          }
+        }
+      }
+
+    double covered = ring * minBinSize;
+    if(best.size() == n && best.back().first <= covered * covered)
+      {
+      break;
+      }
+    }
+
+  for(unsigned int i = 0; i < best.size(); ++i)
+    {
+    ids.push_back(best[i].second);
+    }
+}
+
+void PointLocator::FindPointsWithinRadius(double radius, const double x[3], std::vector<vtkIdType>& ids)
+{
+  ids.clear();
+  Update();
+  if(this->PointBins.empty())
+    {
+    return;
+    }
+
+  double lower[3] = {x[0] - radius, x[1] - radius, x[2] - radius};
+  double upper[3] = {x[0] + radius, x[1] + radius, x[2] + radius};
+  int lowerIndex[3];
+  GetBinIndex(lower, lowerIndex);
+  int upperIndex[3];
+  GetBinIndex(upper, upperIndex);
+
+  double radius2 = radius * radius;
+  for(int k = lowerIndex[2]; k <= upperIndex[2]; ++k)
+    {
+    for(int j = lowerIndex[1]; j <= upperIndex[1]; ++j)
+      {
+      for(int i = lowerIndex[0]; i <= upperIndex[0]; ++i)
+        {
+        vtkIdType bin = GetBinId(i, j, k);
+        for(vtkIdType position = this->BinOffsets[bin]; position < this->BinOffsets[bin] + this->BinCounts[bin]; ++position)
+          {
+          if(Distance2(&this->PointCoordinates[3*this->SortedIds[position]], x) <= radius2)
+            {
+            ids.push_back(this->SortedIds[position]);
+            }
+          }
+        }
+      }
+    }
+}
+
+vtkIdType PointLocator::FindClosestPointToRay(const double p1[3], const double p2[3], double tolerance)
+{
+  Update();
+  if(this->PointBins.empty())
+    {
+    return -1;
+    }
+
+  double direction[3];
+  double length2 = 0.0;
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    direction[i] = p2[i] - p1[i];
+    length2 += direction[i] * direction[i];
+    }
+  if(length2 == 0.0)
+    {
+    return -1;
+    }
+  double length = std::sqrt(length2);
+
+  // Clip the segment against the bounds grown by the tolerance (slab method)
+  double tMin = 0.0;
+  double tMax = 1.0;
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    double lower = this->Bounds[2*i] - tolerance;
+    double upper = this->Bounds[2*i + 1] + tolerance;
+    if(direction[i] == 0.0)
+      {
+      if(p1[i] < lower || p1[i] > upper)
+        {
+        return -1;
+        }
+      continue;
+      }
+    double t1 = (lower - p1[i]) / direction[i];
+    double t2 = (upper - p1[i]) / direction[i];
+    tMin = std::max(tMin, std::min(t1, t2));
+    tMax = std::min(tMax, std::max(t1, t2));
+    }
+  if(tMin > tMax)
+    {
+    return -1;
+    }
+
+  // A new stamp marks every bin as unvisited without clearing the array
+  this->QueryStamp++;
+  if(this->QueryStamp == 0)
+    {
+    std::fill(this->BinVisited.begin(), this->BinVisited.end(), 0);
+    this->QueryStamp = 1;
+    }
+
+  // Walk along the clipped segment and test the bins within the tolerance of each sample
+  double minBinSize = std::min(this->BinSize[0], std::min(this->BinSize[1], this->BinSize[2]));
+  double stepLength = 0.5 * minBinSize;
+  double reach = tolerance + stepLength;
+  double tolerance2 = tolerance * tolerance;
+
+  vtkIdType closestId = -1;
+  double closestT = tMax + 1.0;
+  for(double t = tMin; t <= tMax + stepLength / length; t += stepLength / length)
+    {
+    // Everything still to be visited is further along the ray than the current best
+    if(closestId >= 0 && (t - closestT) * length > reach)
+      {
+      break;
+      }
+
+    double sample[3];
+    double lower[3];
+    double upper[3];
+    for(unsigned int i = 0; i < 3; ++i)
+      {
+      sample[i] = p1[i] + std::min(t, tMax) * direction[i];
+      lower[i] = sample[i] - reach;
+      upper[i] = sample[i] + reach;
+      }
+    int lowerIndex[3];
+    GetBinIndex(lower, lowerIndex);
+    int upperIndex[3];
+    GetBinIndex(upper, upperIndex);
+
+    for(int k = lowerIndex[2]; k <= upperIndex[2]; ++k)
+      {
+      for(int j = lowerIndex[1]; j <= upperIndex[1]; ++j)
+        {
+        for(int i = lowerIndex[0]; i <= upperIndex[0]; ++i)
+          {
+          vtkIdType bin = GetBinId(i, j, k);
+          if(this->BinVisited[bin] == this->QueryStamp)
+            {
+            continue;
+            }
+          this->BinVisited[bin] = this->QueryStamp;
+
+          for(vtkIdType position = this->BinOffsets[bin]; position < this->BinOffsets[bin] + this->BinCounts[bin]; ++position)
+            {
+            const float* p = &this->PointCoordinates[3*this->SortedIds[position]];
+            double projection = 0.0;
+            for(unsigned int c = 0; c < 3; ++c)
+              {
+              projection += (p[c] - p1[c]) * direction[c];
+              }
+            double pointT = projection / length2;
+            if(pointT < 0.0 || pointT > 1.0 || pointT >= closestT)
+              {
+              continue;
+              }
+
+            double closest[3];
+            for(unsigned int c = 0; c < 3; ++c)
+              {
+              closest[c] = p1[c] + pointT * direction[c];
+              }
+            if(Distance2(p, closest) <= tolerance2)
+              {
+              closestId = this->SortedIds[position];
+              closestT = pointT;
+              }
+            }
+          }
+        }
+      }
+    }
+
+  return closestId;
+}
+
+double PointLocator::GetDiagonalLength()
+{
+  Update();
+  double length2 = 0.0;
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    double extent = this->Bounds[2*i + 1] - this->Bounds[2*i];
+    length2 += extent * extent;
+    }
+  return std::sqrt(length2);
+}
@@ -0,0 +1,111 @@
+/*
+Copyright (C) 2010 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PointLocator_H
+#define PointLocator_H
+
+// VTK
+#include <vtkType.h>
+
+// STL
+#include <vector>
+
+// Forward declarations
+class vtkPoints;
+
+/** A uniform grid over a point set. The points are counting-sorted into the bins,
+  * so a query only touches the few bins around it. The grid is updated lazily: a
+  * query first checks the modified time of the points and, if they moved, moves only
+  * the points whose bin changed. The grid extends a little past the points and every
+  * bin has spare room, so a small animation step costs one pass over the coordinates
+  * plus a few swaps. If many points changed bins (or a bin ran out of room) they are
+  * counting-sorted again, which costs about as much as a build; only when a point
+  * leaves the grid or the number of points changes is the grid built from scratch.
+  * The update runs on the thread of the query.
+  */
+class PointLocator
+{
+public:
+  PointLocator();
+
+  void SetPoints(vtkPoints* points);
+
+  /** Update the grid if the points were modified since the last update. */
+  void Update();
+
+  /** Returns -1 if there are no points. */
+  vtkIdType FindClosestPoint(const double x[3]);
+
+  /** The ids of the (at most) 'n' closest points, nearest first. */
+  void FindClosestNPoints(unsigned int n, const double x[3], std::vector<vtkIdType>& ids);
+
+  void FindPointsWithinRadius(double radius, const double x[3], std::vector<vtkIdType>& ids);
+
+  /** Of the points within 'tolerance' of the segment p1-p2, return the one closest
+    * to p1 (i.e. the one in front when p1 is the camera). Returns -1 if there is none.
+    */
+  vtkIdType FindClosestPointToRay(const double p1[3], const double p2[3], double tolerance);
+
+  /** Length of the diagonal of the bounding box of the points. */
+  double GetDiagonalLength();
+
+protected:
+  void Build();
+
+  /** Move the points whose bin changed. Returns false if the grid has to be rebuilt. */
+  bool UpdateBins();
+
+  /** Counting sort of the points into the bins given by PointBins. */
+  void SortBins();
+
+  void UpdateCoordinates();
+  void ComputeBounds(double bounds[6]) const;
+
+  void GetBinIndex(const double x[3], int index[3]) const;
+  vtkIdType GetBinId(const float p[3]) const;
+  vtkIdType GetBinId(int i, int j, int k) const;
+
+  vtkPoints* Points;
+  unsigned long BuildTime; // Modified time of the points when the grid was last updated
+
+  const float* PointCoordinates; // The float coordinates of the points, or Coordinates
+  std::vector<float> Coordinates; // Only used if the points are not floats
+
+  double Bounds[6]; // Of the points
+  double GridBounds[6]; // Of the grid, fixed between builds
+  int Divisions[3];
+  double BinSize[3];
+  double InverseBinSize[3];
+
+  // The points of bin b are SortedIds[BinOffsets[b] + i] for i < BinCounts[b], the rest
+  // of [BinOffsets[b], BinOffsets[b+1]) is spare room for points moving into the bin
+  std::vector<vtkIdType> BinOffsets;
+  std::vector<vtkIdType> BinCounts;
+  std::vector<vtkIdType> SortedIds;
+
+  std::vector<vtkIdType> PointBins; // The bin of each point
+  std::vector<vtkIdType> PointPositions; // The index of each point in SortedIds
+  // Scratch space of UpdateBins: the points that changed bins and their old bins
+  std::vector<vtkIdType> MovedIds;
+  std::vector<vtkIdType> MovedFrom;
+
+  // Marks the bins already visited by the current ray query
+  std::vector<unsigned int> BinVisited;
+  unsigned int QueryStamp;
+};
+
+#endif
@@ -0,0 +1,267 @@
+/*
+Copyright (C) 2011 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Profiler.h"
+
+// STL
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+Profiler::Profiler()
+{
+  this->MaxNumberOfEvents = 1000000;
+  this->OldestEvent = 0;
+  this->FrameStart = 0;
+  this->LastFrameEnd = 0;
+  this->FrameTime = 0.0;
+  this->FrameInterval = 0.0;
+
+#ifdef COLORSPACES_ENABLE_PROFILING
+  this->Enabled = true;
+#else
+  this->Enabled = false;
+#endif
+
+  this->Clock.start();
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+  this->Enabled = enabled;
+}
+
+bool Profiler::GetEnabled() const
+{
+  return this->Enabled;
+}
+
+void Profiler::SetMaxNumberOfEvents(size_t maxNumberOfEvents)
+{
+  if(maxNumberOfEvents == this->MaxNumberOfEvents)
+    {
+    return;
+    }
+  this->MaxNumberOfEvents = std::max<size_t>(maxNumberOfEvents, 1);
+  this->Events.clear();
+  this->OldestEvent = 0;
+}
+
+size_t Profiler::GetMaxNumberOfEvents() const
+{
+  return this->MaxNumberOfEvents;
+}
+
+qint64 Profiler::Now() const
+{
+  return this->Clock.nsecsElapsed();
+}
+
+void Profiler::AddEvent(const char* name, qint64 start, qint64 duration)
+{
+  if(!this->Enabled)
+    {
+    return;
+    }
+
+  Stage* stage = FindStage(name);
+  if(!stage)
+    {
+    Stage newStage;
+    newStage.Name = name;
+    newStage.TotalDuration = 0;
+    newStage.Count = 0;
+    this->Stages.push_back(newStage);
+    stage = &this->Stages.back();
+    }
+  stage->LastDuration = duration;
+  stage->TotalDuration += duration;
+  stage->Count++;
+
+  Event event;
+  event.Name = name;
+  event.Start = start;
+  event.Duration = duration;
+  if(this->Events.size() < this->MaxNumberOfEvents)
+    {
+    this->Events.push_back(event);
+    }
+  else
+    {
+    this->Events[this->OldestEvent] = event;
+    this->OldestEvent = (this->OldestEvent + 1) % this->MaxNumberOfEvents;
+    }
+}
+
+Profiler::Stage* Profiler::FindStage(const char* name)
+{
+  for(size_t i = 0; i < this->Stages.size(); ++i)
+    {
+    // The same literal usually has the same address, so try that before comparing
+    if(this->Stages[i].Name == name || std::strcmp(this->Stages[i].Name, name) == 0)
+      {
+      return &this->Stages[i];
+      }
+    }
+  return 0;
+}
+
+const Profiler::Stage* Profiler::FindStage(const char* name) const
+{
+  return const_cast<Profiler*>(this)->FindStage(name);
+}
+
+void Profiler::BeginFrame()
+{
+  if(!this->Enabled)
+    {
+    return;
+    }
+  this->FrameStart = Now();
+}
+
+void Profiler::EndFrame()
+{
+  if(!this->Enabled)
+    {
+    return;
+    }
+
+  qint64 end = Now();
+  qint64 duration = end - this->FrameStart;
+  AddEvent("Frame", this->FrameStart, duration);
+
+  // Exponential moving average so the overlay does not flicker
+  const double weight = 0.1;
+  if(this->FrameTime == 0.0)
+    {
+    this->FrameTime = duration;
+    }
+  else
+    {
+    this->FrameTime += weight * (duration - this->FrameTime);
+    }
+
+  if(this->LastFrameEnd > 0)
+    {
+    double interval = end - this->LastFrameEnd;
+    if(this->FrameInterval == 0.0)
+      {
+      this->FrameInterval = interval;
+      }
+    else
+      {
+      this->FrameInterval += weight * (interval - this->FrameInterval);
+      }
+    }
+  this->LastFrameEnd = end;
+}
+
+double Profiler::GetFramesPerSecond() const
+{
+  if(this->FrameInterval <= 0.0)
+    {
+    return 0.0;
+    }
+  return 1.0e9 / this->FrameInterval;
+}
+
+double Profiler::GetFrameTime() const
+{
+  return this->FrameTime * 1.0e-6;
+}
+
+double Profiler::GetLastDuration(const char* name) const
+{
+  const Stage* stage = FindStage(name);
+  if(!stage)
+    {
+    return 0.0;
+    }
+  return stage->LastDuration * 1.0e-6;
+}
+
+void Profiler::WriteSummary(std::ostream& os) const
+{
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  for(size_t i = 0; i < this->Stages.size(); ++i)
+    {
+    const Stage& stage = this->Stages[i];
+    os << std::left << std::setw(16) << stage.Name << std::right
+       << std::setw(8) << stage.Count << " events"
+       << std::setw(12) << stage.TotalDuration * 1.0e-6 << " ms total"
+       << std::setw(10) << stage.TotalDuration * 1.0e-6 / stage.Count << " ms average" << std::endl;
+    }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+bool Profiler::WriteChromeTrace(const std::string& fileName) const
+{
+  std::ofstream fout(fileName.c_str());
+  if(!fout)
+    {
+    return false;
+    }
+
+  // Timestamps and durations are in microseconds
+  fout << "{\"traceEvents\":[" << std::endl;
+  for(size_t i = 0; i < this->Events.size(); ++i)
+    {
+    const Event& event = this->Events[(this->OldestEvent + i) % this->Events.size()];
+    fout << "{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+         << ",\"ts\":" << event.Start / 1000 << "." << event.Start % 1000 / 100
+         << ",\"dur\":" << event.Duration / 1000 << "." << event.Duration % 1000 / 100 << "}";
+    if(i + 1 < this->Events.size())
+      {
+      fout << ",";
+      }
+    fout << std::endl;
+    }
+  fout << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+  return fout.good();
+}
+
+void Profiler::Clear()
+{
+  this->Events.clear();
+  this->OldestEvent = 0;
+  this->Stages.clear();
+  this->FrameTime = 0.0;
+  this->FrameInterval = 0.0;
+  this->LastFrameEnd = 0;
+}
+
+ScopedTimer::ScopedTimer(Profiler* profiler, const char* name) : TheProfiler(profiler), Name(name), Start(0)
+{
+  if(this->TheProfiler && this->TheProfiler->GetEnabled())
+    {
+    this->Start = this->TheProfiler->Now();
+    }
+}
+
+ScopedTimer::~ScopedTimer()
+{
+  if(this->TheProfiler && this->TheProfiler->GetEnabled())
+    {
+    this->TheProfiler->AddEvent(this->Name, this->Start, this->TheProfiler->Now() - this->Start);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+Copyright (C) 2011 David Doria, daviddoria@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef Profiler_H
+#define Profiler_H
+
+// Qt
+#include <QElapsedTimer>
+
+// STL
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** Collects timed events for each frame of the animation. The most recent events can be
+  * written in the Chrome trace format (load the file in chrome://tracing).
+  * When the profiler is disabled every call returns immediately, so it is
+  * safe to leave the instrumentation in the hot path.
+  */
+class Profiler
+{
+public:
+  Profiler();
+
+  void SetEnabled(bool enabled);
+  bool GetEnabled() const;
+
+  /** The number of events the trace holds before the oldest are dropped. Changing it
+    * drops the recorded events (but not the per-name statistics).
+    */
+  void SetMaxNumberOfEvents(size_t maxNumberOfEvents);
+  size_t GetMaxNumberOfEvents() const;
+
+  /** Nanoseconds since the profiler was created. */
+  qint64 Now() const;
+
+  /** Record an event. 'name' must outlive the profiler (use string literals). */
+  void AddEvent(const char* name, qint64 start, qint64 duration);
+
+  void BeginFrame();
+  void EndFrame();
+
+  /** Smoothed statistics over the recent frames. */
+  double GetFramesPerSecond() const;
+  double GetFrameTime() const; // milliseconds
+
+  /** Duration of the most recent event with this name, in milliseconds. */
+  double GetLastDuration(const char* name) const;
+
+  /** Print the number of events, total and average duration of each name (including
+    * events the trace no longer holds).
+    */
+  void WriteSummary(std::ostream& os) const;
+
+  /** Write the recorded events, oldest first. */
+  bool WriteChromeTrace(const std::string& fileName) const;
+
+  void Clear();
+
+private:
+  struct Event
+  {
+    const char* Name;
+    qint64 Start;
+    qint64 Duration;
+  };
+
+  // A ring buffer: once MaxNumberOfEvents have been collected each new event
+  // replaces the oldest one, so a long session does not grow without bound.
+  std::vector<Event> Events;
+  size_t MaxNumberOfEvents;
+  size_t OldestEvent; // Index of the oldest event once the buffer is full
+
+  // The latest and accumulated duration of each event name, kept apart from the trace
+  // so the overlay doesn't have to search it. There are only a handful of names.
+  struct Stage
+  {
+    const char* Name;
+    qint64 LastDuration;
+    qint64 TotalDuration;
+    qint64 Count;
+  };
+  std::vector<Stage> Stages;
+
+  Stage* FindStage(const char* name);
+  const Stage* FindStage(const char* name) const;
+
+  QElapsedTimer Clock;
+  bool Enabled;
+
+  qint64 FrameStart;
+  qint64 LastFrameEnd;
+  double FrameTime; // Smoothed, in nanoseconds
+  double FrameInterval; // Smoothed time between the end of consecutive frames, in nanoseconds
+};
+
+/** Records the lifetime of the enclosing scope as an event. A null profiler is allowed. */
+class ScopedTimer
+{
+public:
+  ScopedTimer(Profiler* profiler, const char* name);
+  ~ScopedTimer();
+
+private:
+  Profiler* TheProfiler;
+  const char* Name;
+  qint64 Start;
+};
+
+#define PROFILE_SCOPE_CONCATENATE_DETAIL(a, b) a##b
+#define PROFILE_SCOPE_CONCATENATE(a, b) PROFILE_SCOPE_CONCATENATE_DETAIL(a, b)
+
+// Compiled out entirely unless COLORSPACES_ENABLE_PROFILING is defined.
+#ifdef COLORSPACES_ENABLE_PROFILING
+  #define PROFILE_SCOPE(profiler, name) ScopedTimer PROFILE_SCOPE_CONCATENATE(scopedTimer, __LINE__)(profiler, name)
+#else
+  #define PROFILE_SCOPE(profiler, name)
+#endif
+
+#endif
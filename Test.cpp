@@ -1,17 +1,23 @@
+#include "ColorConversions.h"
 #include "Conversions.h"
 
+#include <algorithm> // min,max
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 
-#include <vtkMath.h>
-
 static void TestHSV();
 static void TestCIELab();
+static bool TestGamutMapping();
+static bool TestCAPI();
 
 int main()
 {
   TestHSV();
   //TestCIELab();
-  return 0;
+  bool success = TestGamutMapping();
+  success = TestCAPI() && success;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 void TestCIELab()
@@ -30,7 +36,148 @@ void TestHSV()
     
     float hsv[3];
 
-    vtkMath::RGBToHSV(rgb, hsv);
+    RGBtoHSV(rgb, hsv);
     std::cout << "HSV: " << hsv[0] << " " << hsv[1] << " " << hsv[2] << std::endl;
-    std::cout << "HSV: " << 2.0f * vtkMath::Pi() * hsv[0] << " " << hsv[1] << " " << hsv[2] << std::endl;
+    std::cout << "HSV: " << 2.0f * 3.14159265f * hsv[0] << " " << hsv[1] << " " << hsv[2] << std::endl;
+}
+
+bool TestGamutMapping()
+{
+  // An in-gamut color should survive the round trip, the others are outside of sRGB
+  unsigned char original[3] = {176, 43, 0};
+  float cieLab[4*3];
+  RGBtoCIELab(original, cieLab);
+  float outside[3*3] = {50, 100, -100,   90, -90, 90,   105, 0, 0};
+  for(unsigned int i = 0; i < 3*3; ++i)
+    {
+    cieLab[3 + i] = outside[i];
+    }
+
+  bool success = true;
+  const char* modeNames[3] = {"Clip", "ChromaReduction", "Compression"};
+  GamutMappingEnum modes[3] = {GAMUT_CLIP, GAMUT_CHROMA_REDUCTION, GAMUT_COMPRESSION};
+  for(unsigned int mode = 0; mode < 3; ++mode)
+    {
+    unsigned char rgb[4*3];
+    unsigned char mask[4];
+    unsigned int count = CIELabtoRGBGamutMapped(cieLab, 4, rgb, modes[mode], mask);
+    std::cout << modeNames[mode] << ": " << count << " out of gamut (expected 3)" << std::endl;
+    bool modeSuccess = count == 3 && mask[0] == 0 && mask[1] && mask[2] && mask[3];
+    for(unsigned int i = 0; i < 4; ++i)
+      {
+      std::cout << "  RGB: " << static_cast<int>(rgb[3*i]) << " " << static_cast<int>(rgb[3*i + 1]) << " "
+                << static_cast<int>(rgb[3*i + 2]) << " mask: " << static_cast<int>(mask[i]) << std::endl;
+      }
+
+    // Compression also moves in-gamut colors near the boundary, the others must leave them alone
+    if(modes[mode] != GAMUT_COMPRESSION &&
+       (rgb[0] != original[0] || rgb[1] != original[1] || rgb[2] != original[2]))
+      {
+      modeSuccess = false;
+      }
+
+    // The mapped colors must be in gamut themselves
+    float mappedCIELab[4*3];
+    for(unsigned int i = 0; i < 4; ++i)
+      {
+      RGBtoCIELab(&rgb[3*i], &mappedCIELab[3*i]);
+      }
+    unsigned char remapped[4*3];
+    if(CIELabtoRGBGamutMapped(mappedCIELab, 4, remapped, GAMUT_CLIP) != 0)
+      {
+      modeSuccess = false;
+      }
+
+    for(unsigned int i = 1; i < 4; ++i)
+      {
+      const float* input = &cieLab[3*i];
+      const float* mapped = &mappedCIELab[3*i];
+      if(modes[mode] == GAMUT_CLIP)
+        {
+        // Clipping clamps each channel of the unmapped color
+        float unmapped[3];
+        CIELabtoRGB(input, unmapped);
+        for(unsigned int component = 0; component < 3; ++component)
+          {
+          float expected = std::min(255.0f, std::max(0.0f, unmapped[component]));
+          if(std::fabs(rgb[3*i + component] - expected) > 1.0f)
+            {
+            modeSuccess = false;
+            }
+          }
+        continue;
+        }
+
+      // The other modes only reduce the chroma, at the (clamped) L and hue of the input
+      float L = std::min(100.0f, std::max(0.0f, input[0]));
+      float chroma = std::sqrt(input[1] * input[1] + input[2] * input[2]);
+      float mappedChroma = std::sqrt(mapped[1] * mapped[1] + mapped[2] * mapped[2]);
+      if(std::fabs(mapped[0] - L) > 1.5f || mappedChroma > chroma + 1.0f)
+        {
+        modeSuccess = false;
+        }
+      if(chroma > 0.0f && mappedChroma > 5.0f)
+        {
+        float hueDifference = std::atan2(input[2] * mapped[1] - input[1] * mapped[2],
+                                         input[1] * mapped[1] + input[2] * mapped[2]);
+        if(std::fabs(hueDifference) > 3.0f * 3.14159265f / 180.0f)
+          {
+          modeSuccess = false;
+          }
+        }
+      }
+
+    if(!modeSuccess)
+      {
+      std::cout << modeNames[mode] << " failed" << std::endl;
+      success = false;
+      }
+    }
+
+  return success;
+}
+
+bool TestCAPI()
+{
+  // The batch C functions must agree with the C++ ones
+  unsigned char rgb[2*3] = {176, 43, 0,   12, 200, 90};
+  float hsv[2*3];
+  float cieLab[2*3];
+  ColorSpaces_RGBToHSV(rgb, 2, hsv);
+  ColorSpaces_RGBToCIELab(rgb, 2, cieLab);
+
+  bool success = ColorSpaces_GetAPIVersion() == COLORSPACES_API_VERSION;
+  for(unsigned int i = 0; i < 2; ++i)
+    {
+    float normalized[3] = {rgb[3*i] / 255.0f, rgb[3*i + 1] / 255.0f, rgb[3*i + 2] / 255.0f};
+    float expectedHSV[3];
+    RGBtoHSV(normalized, expectedHSV);
+    float expectedCIELab[3];
+    RGBtoCIELab(&rgb[3*i], expectedCIELab);
+    for(unsigned int component = 0; component < 3; ++component)
+      {
+      if(std::fabs(hsv[3*i + component] - expectedHSV[component]) > 1e-6f ||
+         std::fabs(cieLab[3*i + component] - expectedCIELab[component]) > 1e-6f)
+        {
+        success = false;
+        }
+      }
+    }
+
+  unsigned char roundTrip[2*3];
+  size_t count = ColorSpaces_CIELabToRGB(cieLab, 2, roundTrip, COLORSPACES_GAMUT_CHROMA_REDUCTION, 0);
+  for(unsigned int i = 0; i < 2*3; ++i)
+    {
+    if(roundTrip[i] != rgb[i])
+      {
+      success = false;
+      }
+    }
+  if(count != 0 || ColorSpaces_CIELabToRGB(cieLab, 2, roundTrip, -1, 0) != COLORSPACES_ERROR)
+    {
+    success = false;
+    }
+
+  std::cout << "C API: " << (success ? "passed" : "failed") << std::endl;
+  return success;
 }
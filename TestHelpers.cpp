@@ -0,0 +1,172 @@
+#include "Helpers.h"
+
+// VTK
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+// STL
+#include <cstdlib>
+#include <iostream>
+
+static bool TestRepack();
+static bool TestAlphaComposite();
+static bool TestInvalidInput();
+
+int main()
+{
+  std::srand(0);
+
+  bool success = TestRepack();
+  success = TestAlphaComposite() && success;
+  success = TestInvalidInput() && success;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static vtkSmartPointer<vtkImageData> CreateRandomImage(int width, int height, int numberOfComponents)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(width, height, 1);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, numberOfComponents);
+  unsigned char* values = static_cast<unsigned char*>(image->GetScalarPointer());
+  for(int i = 0; i < width * height * numberOfComponents; ++i)
+    {
+    values[i] = static_cast<unsigned char>(std::rand() % 256);
+    }
+  return image;
+}
+
+static unsigned char* GetPixel(vtkImageData* image, int pixel)
+{
+  return static_cast<unsigned char*>(image->GetScalarPointer()) + pixel * image->GetNumberOfScalarComponents();
+}
+
+// The widths cover the remainders of the four pixel steps and more than one blending chunk
+static const int Widths[] = {1, 2, 3, 4, 5, 7, 8, 13, 300};
+static const unsigned int NumberOfWidths = sizeof(Widths) / sizeof(Widths[0]);
+
+bool TestRepack()
+{
+  unsigned int failures = 0;
+  for(unsigned int i = 0; i < NumberOfWidths; ++i)
+    {
+    vtkSmartPointer<vtkImageData> rgb = CreateRandomImage(Widths[i], 3, 3);
+    vtkSmartPointer<vtkImageData> rgba = vtkSmartPointer<vtkImageData>::New();
+    Helpers::RGBToRGBA(rgb, rgba, 7);
+
+    vtkSmartPointer<vtkImageData> rgba2 = CreateRandomImage(Widths[i], 3, 4);
+    vtkSmartPointer<vtkImageData> rgb2 = vtkSmartPointer<vtkImageData>::New();
+    Helpers::RGBAToRGB(rgba2, rgb2);
+
+    for(int pixel = 0; pixel < 3 * Widths[i]; ++pixel)
+      {
+      for(unsigned int component = 0; component < 3; ++component)
+        {
+        if(GetPixel(rgba, pixel)[component] != GetPixel(rgb, pixel)[component] ||
+           GetPixel(rgb2, pixel)[component] != GetPixel(rgba2, pixel)[component])
+          {
+          failures++;
+          }
+        }
+      if(GetPixel(rgba, pixel)[3] != 7)
+        {
+        failures++;
+        }
+      }
+    }
+
+  std::cout << "Repack: " << failures << " wrong values" << std::endl;
+  return failures == 0;
+}
+
+/** The expected result of blending 'foreground' over 'background' for one pixel. */
+static void Blend(const unsigned char* foreground, const unsigned char* background, int backgroundComponents, unsigned char* output)
+{
+  unsigned int alpha = foreground[3];
+  for(unsigned int component = 0; component < 3; ++component)
+    {
+    output[component] = (foreground[component] * alpha + background[component] * (255 - alpha) + 127) / 255;
+    }
+  if(backgroundComponents == 4)
+    {
+    output[3] = alpha + (background[3] * (255 - alpha) + 127) / 255;
+    }
+}
+
+bool TestAlphaComposite()
+{
+  unsigned int failures = 0;
+  for(int backgroundComponents = 3; backgroundComponents <= 4; ++backgroundComponents)
+    {
+    for(unsigned int i = 0; i < NumberOfWidths; ++i)
+      {
+      vtkSmartPointer<vtkImageData> foreground = CreateRandomImage(Widths[i], 2, 4);
+      vtkSmartPointer<vtkImageData> background = CreateRandomImage(Widths[i], 2, backgroundComponents);
+      vtkSmartPointer<vtkImageData> output = vtkSmartPointer<vtkImageData>::New();
+      Helpers::AlphaComposite(foreground, background, output);
+
+      // Blending into the background itself must give the same result
+      vtkSmartPointer<vtkImageData> inPlace = vtkSmartPointer<vtkImageData>::New();
+      inPlace->DeepCopy(background);
+      Helpers::AlphaComposite(foreground, inPlace, inPlace);
+
+      for(int pixel = 0; pixel < 2 * Widths[i]; ++pixel)
+        {
+        unsigned char expected[4];
+        Blend(GetPixel(foreground, pixel), GetPixel(background, pixel), backgroundComponents, expected);
+        for(int component = 0; component < backgroundComponents; ++component)
+          {
+          if(GetPixel(output, pixel)[component] != expected[component] ||
+             GetPixel(inPlace, pixel)[component] != expected[component])
+            {
+            failures++;
+            }
+          }
+        }
+      }
+    }
+
+  std::cout << "AlphaComposite: " << failures << " wrong values" << std::endl;
+  return failures == 0;
+}
+
+bool TestInvalidInput()
+{
+  // Mismatched dimensions or scalar types must leave the output alone
+  vtkSmartPointer<vtkImageData> foreground = CreateRandomImage(5, 2, 4);
+  vtkSmartPointer<vtkImageData> background = CreateRandomImage(6, 2, 3);
+  vtkSmartPointer<vtkImageData> copy = vtkSmartPointer<vtkImageData>::New();
+  copy->DeepCopy(background);
+  Helpers::AlphaComposite(foreground, background, background);
+
+  vtkSmartPointer<vtkImageData> floatImage = vtkSmartPointer<vtkImageData>::New();
+  floatImage->SetDimensions(5, 2, 1);
+  floatImage->AllocateScalars(VTK_FLOAT, 3);
+  float* floatValues = static_cast<float*>(floatImage->GetScalarPointer());
+  for(int i = 0; i < 5 * 2 * 3; ++i)
+    {
+    floatValues[i] = 0.5f;
+    }
+  Helpers::AlphaComposite(foreground, floatImage, floatImage);
+
+  const unsigned char pixel[3] = {1, 2, 3};
+  Helpers::ParallelFill(floatImage, pixel);
+
+  bool success = true;
+  for(int i = 0; i < 6 * 2 * 3; ++i)
+    {
+    if(static_cast<unsigned char*>(background->GetScalarPointer())[i] != static_cast<unsigned char*>(copy->GetScalarPointer())[i])
+      {
+      success = false;
+      }
+    }
+  for(int i = 0; i < 5 * 2 * 3; ++i)
+    {
+    if(floatValues[i] != 0.5f)
+      {
+      success = false;
+      }
+    }
+
+  std::cout << "Invalid input: " << (success ? "passed" : "failed") << std::endl;
+  return success;
+}
@@ -0,0 +1,224 @@
+#include "PointLocator.h"
+
+// VTK
+#include <vtkPoints.h>
+#include <vtkSmartPointer.h>
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+static bool TestPointSet(const char* name, vtkPoints* points);
+static bool TestMovingPoints();
+static vtkSmartPointer<vtkPoints> CreateRandomPoints(unsigned int numberOfPoints, bool flat, int dataType);
+
+int main()
+{
+  std::srand(0);
+
+  bool success = TestPointSet("Random", CreateRandomPoints(2000, false, VTK_FLOAT));
+  success = TestPointSet("Flat", CreateRandomPoints(2000, true, VTK_FLOAT)) && success;
+  success = TestPointSet("Double", CreateRandomPoints(500, false, VTK_DOUBLE)) && success;
+  success = TestPointSet("Single", CreateRandomPoints(1, false, VTK_FLOAT)) && success;
+  success = TestMovingPoints() && success;
+
+  // A point set that is modified after the first query must be rebuilt
+  vtkSmartPointer<vtkPoints> points = CreateRandomPoints(500, false, VTK_FLOAT);
+  PointLocator locator;
+  locator.SetPoints(points);
+  double origin[3] = {0, 0, 0};
+  locator.FindClosestPoint(origin);
+  points->SetPoint(17, origin);
+  points->Modified();
+  if(locator.FindClosestPoint(origin) != 17)
+    {
+    std::cout << "Rebuild failed" << std::endl;
+    success = false;
+    }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+vtkSmartPointer<vtkPoints> CreateRandomPoints(unsigned int numberOfPoints, bool flat, int dataType)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataType(dataType);
+  for(unsigned int i = 0; i < numberOfPoints; ++i)
+    {
+    double p[3];
+    for(unsigned int component = 0; component < 3; ++component)
+      {
+      p[component] = 255.0 * std::rand() / RAND_MAX;
+      }
+    if(flat)
+      {
+      p[2] = 50.0;
+      }
+    points->InsertNextPoint(p);
+    }
+  return points;
+}
+
+static double Distance2(vtkPoints* points, vtkIdType pointId, const double x[3])
+{
+  double p[3];
+  points->GetPoint(pointId, p);
+  return (p[0] - x[0]) * (p[0] - x[0]) + (p[1] - x[1]) * (p[1] - x[1]) + (p[2] - x[2]) * (p[2] - x[2]);
+}
+
+/** The parameter along p1-p2 of the brute force FindClosestPointToRay, or 2 if no point is within 'tolerance'. */
+static double ClosestRayParameter(vtkPoints* points, const double p1[3], const double p2[3], double tolerance)
+{
+  double direction[3] = {p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2]};
+  double length2 = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+  double closestT = 2.0;
+  for(vtkIdType pointId = 0; pointId < points->GetNumberOfPoints(); ++pointId)
+    {
+    double p[3];
+    points->GetPoint(pointId, p);
+    double t = ((p[0] - p1[0]) * direction[0] + (p[1] - p1[1]) * direction[1] + (p[2] - p1[2]) * direction[2]) / length2;
+    double closest[3] = {p1[0] + t * direction[0], p1[1] + t * direction[1], p1[2] + t * direction[2]};
+    if(t >= 0.0 && t <= 1.0 && Distance2(points, pointId, closest) <= tolerance * tolerance)
+      {
+      closestT = std::min(closestT, t);
+      }
+    }
+  return closestT;
+}
+
+/** Compare the locator queries with brute force at random positions in and around the points. */
+static unsigned int CountMismatches(PointLocator& locator, vtkPoints* points)
+{
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  unsigned int failures = 0;
+  for(unsigned int query = 0; query < 50; ++query)
+    {
+    double x[3];
+    for(unsigned int component = 0; component < 3; ++component)
+      {
+      x[component] = 300.0 * std::rand() / RAND_MAX - 20.0;
+      }
+
+    // k nearest: the distances must match (ties may be returned in any order)
+    std::vector<std::pair<double, vtkIdType> > all;
+    for(vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+      {
+      all.push_back(std::make_pair(Distance2(points, pointId, x), pointId));
+      }
+    std::sort(all.begin(), all.end());
+
+    const unsigned int n = 5;
+    std::vector<vtkIdType> ids;
+    locator.FindClosestNPoints(n, x, ids);
+    if(ids.size() != std::min<std::size_t>(n, all.size()))
+      {
+      failures++;
+      }
+    for(unsigned int i = 0; i < ids.size(); ++i)
+      {
+      if(Distance2(points, ids[i], x) != all[i].first)
+        {
+        failures++;
+        }
+      }
+    if(locator.FindClosestPoint(x) < 0 || Distance2(points, locator.FindClosestPoint(x), x) != all[0].first)
+      {
+      failures++;
+      }
+
+    // Radius: the same set of points
+    double radius = 20.0;
+    std::vector<vtkIdType> expected;
+    for(unsigned int i = 0; i < all.size() && all[i].first <= radius * radius; ++i)
+      {
+      expected.push_back(all[i].second);
+      }
+    locator.FindPointsWithinRadius(radius, x, ids);
+    std::sort(expected.begin(), expected.end());
+    std::sort(ids.begin(), ids.end());
+    if(ids != expected)
+      {
+      failures++;
+      }
+
+    // Ray: a slanted segment through the bounds, the closest point to p1 within the tolerance
+    double p1[3] = {x[0], x[1], -100.0};
+    double p2[3] = {x[0] + 10.0, x[1] - 5.0, 300.0};
+    double tolerance = 5.0;
+    double expectedT = ClosestRayParameter(points, p1, p2, tolerance);
+    vtkIdType pointId = locator.FindClosestPointToRay(p1, p2, tolerance);
+    if(pointId < 0)
+      {
+      if(expectedT <= 1.0)
+        {
+        failures++;
+        }
+      continue;
+      }
+    double p[3];
+    points->GetPoint(pointId, p);
+    double direction[3] = {p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2]};
+    double length2 = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+    double t = ((p[0] - p1[0]) * direction[0] + (p[1] - p1[1]) * direction[1] + (p[2] - p1[2]) * direction[2]) / length2;
+    if(std::fabs(t - expectedT) > 1e-12)
+      {
+      failures++;
+      }
+    }
+  return failures;
+}
+
+bool TestPointSet(const char* name, vtkPoints* points)
+{
+  PointLocator locator;
+  locator.SetPoints(points);
+  unsigned int failures = CountMismatches(locator, points);
+
+  std::cout << name << ": " << failures << " mismatches with brute force" << std::endl;
+  return failures == 0;
+}
+
+/** Move the points like a transition does and compare after every step. Small steps move
+  * a few points between bins, gathering some of them overflows a bin, larger steps re-sort
+  * all of them, and growing the points past the grid rebuilds it.
+  */
+bool TestMovingPoints()
+{
+  vtkSmartPointer<vtkPoints> points = CreateRandomPoints(2000, false, VTK_FLOAT);
+  PointLocator locator;
+  locator.SetPoints(points);
+
+  const double jitter[] = {1.0, 1.0, 1.0, 0.0, 10.0, 0.0, 1.0};
+  const unsigned int numberOfSteps = sizeof(jitter) / sizeof(jitter[0]);
+  unsigned int failures = 0;
+  for(unsigned int step = 0; step < numberOfSteps; ++step)
+    {
+    for(vtkIdType pointId = 0; pointId < points->GetNumberOfPoints(); ++pointId)
+      {
+      double p[3];
+      points->GetPoint(pointId, p);
+      for(unsigned int component = 0; component < 3; ++component)
+        {
+        if(step == 3 && pointId % 20 == 0)
+          {
+          p[component] = 100.0;
+          }
+        else if(step == 5)
+          {
+          p[component] = 1.5 * p[component] - 60.0;
+          }
+        p[component] += jitter[step] * (2.0 * std::rand() / RAND_MAX - 1.0);
+        }
+      points->SetPoint(pointId, p);
+      }
+    points->Modified();
+    failures += CountMismatches(locator, points);
+    }
+
+  std::cout << "Moving: " << failures << " mismatches with brute force" << std::endl;
+  return failures == 0;
+}
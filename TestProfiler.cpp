@@ -0,0 +1,143 @@
+#include "Profiler.h"
+
+// STL
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static bool TestRingBuffer();
+static bool TestStages();
+static bool TestClear();
+
+int main()
+{
+  bool success = TestRingBuffer();
+  success = TestStages() && success;
+  success = TestClear() && success;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static const char* TraceFileName = "TestProfiler.json";
+
+/** Event i is named "Even" or "Odd", starts at i ms and lasts i + 1 us. */
+static void AddEvents(Profiler& profiler, unsigned int numberOfEvents)
+{
+  for(unsigned int i = 0; i < numberOfEvents; ++i)
+    {
+    profiler.AddEvent(i % 2 == 0 ? "Even" : "Odd", i * 1000000LL, (i + 1) * 1000LL);
+    }
+}
+
+/** The names and start times (in microseconds) of the events in the trace file, in file order. */
+static bool ReadTrace(std::vector<std::string>& names, std::vector<double>& starts)
+{
+  std::ifstream fin(TraceFileName);
+  if(!fin)
+    {
+    return false;
+    }
+  std::stringstream contents;
+  contents << fin.rdbuf();
+  std::string trace = contents.str();
+
+  names.clear();
+  starts.clear();
+  const std::string nameKey = "\"name\":\"";
+  const std::string startKey = "\"ts\":";
+  for(size_t position = trace.find(nameKey); position != std::string::npos; position = trace.find(nameKey, position))
+    {
+    position += nameKey.size();
+    names.push_back(trace.substr(position, trace.find('"', position) - position));
+    position = trace.find(startKey, position) + startKey.size();
+    starts.push_back(std::atof(trace.c_str() + position));
+    }
+  return true;
+}
+
+bool TestRingBuffer()
+{
+  Profiler profiler;
+  profiler.SetEnabled(true);
+  profiler.SetMaxNumberOfEvents(5);
+  AddEvents(profiler, 12);
+
+  // Only the last 5 events are kept, and they are written oldest first
+  std::vector<std::string> names;
+  std::vector<double> starts;
+  bool success = profiler.WriteChromeTrace(TraceFileName) && ReadTrace(names, starts) && starts.size() == 5;
+  for(unsigned int i = 0; success && i < starts.size(); ++i)
+    {
+    unsigned int event = 7 + i;
+    if(starts[i] != event * 1000.0 || names[i] != (event % 2 == 0 ? "Even" : "Odd"))
+      {
+      success = false;
+      }
+    }
+
+  std::cout << "Ring buffer: " << (success ? "passed" : "failed") << std::endl;
+  return success;
+}
+
+bool TestStages()
+{
+  Profiler profiler;
+  profiler.SetEnabled(true);
+  profiler.SetMaxNumberOfEvents(5);
+  AddEvents(profiler, 12);
+
+  // A name with another address must find the same stage
+  std::string odd = "Odd";
+  bool success = std::fabs(profiler.GetLastDuration("Even") - 0.011) < 1.0e-9 &&
+                 std::fabs(profiler.GetLastDuration(odd.c_str()) - 0.012) < 1.0e-9 &&
+                 profiler.GetLastDuration("Missing") == 0.0;
+
+  // The counts include the events the trace dropped
+  std::stringstream summary;
+  profiler.WriteSummary(summary);
+  std::string name;
+  std::string line;
+  unsigned int numberOfStages = 0;
+  while(std::getline(summary, line))
+    {
+    std::stringstream fields(line);
+    unsigned int count = 0;
+    fields >> name >> count;
+    if((name != "Even" && name != "Odd") || count != 6)
+      {
+      success = false;
+      }
+    numberOfStages++;
+    }
+  success = success && numberOfStages == 2;
+
+  std::cout << "Stages: " << (success ? "passed" : "failed") << std::endl;
+  return success;
+}
+
+bool TestClear()
+{
+  Profiler profiler;
+  profiler.SetEnabled(true);
+  profiler.SetMaxNumberOfEvents(5);
+  AddEvents(profiler, 12);
+  profiler.Clear();
+
+  std::vector<std::string> names;
+  std::vector<double> starts;
+  std::stringstream summary;
+  profiler.WriteSummary(summary);
+  bool success = profiler.GetLastDuration("Even") == 0.0 && summary.str().empty() &&
+                 profiler.WriteChromeTrace(TraceFileName) && ReadTrace(names, starts) && names.empty();
+
+  // Recording starts over from an empty buffer
+  AddEvents(profiler, 2);
+  success = success && profiler.WriteChromeTrace(TraceFileName) && ReadTrace(names, starts) &&
+            starts.size() == 2 && starts[0] == 0.0 && starts[1] == 1000.0;
+
+  std::cout << "Clear: " << (success ? "passed" : "failed") << std::endl;
+  return success;
+}
@@ -15,18 +15,70 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-// Instantiate and display the GUI
+// Instantiate and display the GUI, or export a transition without it:
+// ColorSpaces --export From To NumberOfFrames OutputPrefix [TraceFile]
+// where From and To are RGB, HSV or CIELab. The frame timings are written to
+// TraceFile (Chrome trace format) if it is given.
 
 #include <QApplication>
 
+#include "AnimationExporter.h"
 #include "MainWindow.h"
 
+// STL
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static int Export(int argc, char** argv);
+
 int main(int argc, char** argv)
 {
+  if(argc > 1 && std::string(argv[1]) == "--export")
+    {
+    return Export(argc, argv);
+    }
+
   QApplication app(argc, argv);
 
   MainWindow form;
   form.show();
 
   return app.exec();
-}
\ No newline at end of file
+}
+
+int Export(int argc, char** argv)
+{
+  if(argc != 6 && argc != 7)
+    {
+    std::cerr << "Usage: " << argv[0] << " --export From To NumberOfFrames OutputPrefix [TraceFile]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ColorSpaceModel::SpaceEnum from;
+  ColorSpaceModel::SpaceEnum to;
+  if(!ColorSpaceModel::SpaceFromString(argv[2], from) || !ColorSpaceModel::SpaceFromString(argv[3], to))
+    {
+    std::cerr << "Color spaces must be RGB, HSV or CIELab." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  int numberOfFrames = atoi(argv[4]);
+  if(numberOfFrames <= 0)
+    {
+    std::cerr << "NumberOfFrames must be positive." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  AnimationExporter exporter;
+  exporter.SetFrom(from);
+  exporter.SetTo(to);
+  exporter.SetNumberOfFrames(numberOfFrames);
+  exporter.SetOutputPrefix(argv[5]);
+  if(argc == 7)
+    {
+    exporter.SetTraceFileName(argv[6]);
+    }
+
+  return exporter.Export() ? EXIT_SUCCESS : EXIT_FAILURE;
+}